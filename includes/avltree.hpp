@@ -6,14 +6,17 @@
 # include <algorithm>
 # include "utils.hpp"
 # include "iterator.hpp"
+# include "node_pool.hpp"
+# include "node_update.hpp"
 
 namespace ft
 {
 	/* tree node */
-	template <typename T>
+	template <typename T, typename Metadata = ft::null_metadata>
 	struct tree_node
 	{
 		typedef T			value_type;
+		typedef Metadata	metadata_type;
 		typedef tree_node	node_type;
 		typedef tree_node*	node_pointer;
 
@@ -21,52 +24,81 @@ namespace ft
 		node_pointer	left;
 		node_pointer	right;
 		value_type		value;
+		int				height;
 		bool			is_sentinel;
+		metadata_type	metadata;
 
-		tree_node() : parent(NULL), left(NULL), right(NULL), value(value_type()), is_sentinel(false) {}
-		tree_node(const value_type& v) : parent(NULL), left(NULL), right(NULL), value(v), is_sentinel(false) {}
+		tree_node() : parent(NULL), left(NULL), right(NULL), value(value_type()), height(0), is_sentinel(false), metadata() {}
+		tree_node(const value_type& v) : parent(NULL), left(NULL), right(NULL), value(v), height(0), is_sentinel(false), metadata() {}
+#if __cplusplus >= 201103L
+		// value built in place from args, the tag keeps this away from the copy constructor
+		struct emplace_tag {};
+
+		template <typename... Args>
+		tree_node(emplace_tag, Args&&... args)
+		: parent(NULL), left(NULL), right(NULL), value(std::forward<Args>(args)...), height(0), is_sentinel(false), metadata() {}
+#endif
 	};
 	
 
+	template <typename Tree>
+	struct tree_algebra;
+
 	/* avl tree */
-	template <typename T, typename Compare, typename Alloc>
+	// KeyOfValue extracts the Key that Compare orders from a stored value,
+	// PoolPolicy picks where nodes come from, see node_pool.hpp, and
+	// NodeUpdate what extra data every node carries, see node_update.hpp
+	template <typename Key, typename T, typename KeyOfValue, typename Compare, typename Alloc,
+		typename PoolPolicy = ft::node_pool_policy, typename NodeUpdate = ft::null_node_update>
 	class tree
 	{
+		template <typename> friend struct tree_algebra;
+
 	public:
+		typedef Key														key_type;
 		typedef T														value_type;
-		typedef Compare													value_compare;
-		typedef tree_node<value_type>									node_type;
+		typedef KeyOfValue												key_of_value;
+		typedef Compare													key_compare;
+		typedef NodeUpdate												node_update;
+		typedef tree_node<value_type, typename node_update::metadata_type>	node_type;
 		typedef typename node_type::node_pointer						node_pointer;
 		typedef typename Alloc::template rebind<node_type>::other		allocator_type;
+		typedef typename PoolPolicy::template rebind<node_type, allocator_type>::other	pool_type;
 		typedef	typename ft::tree_iterator<value_type, node_type>       iterator;
 		typedef typename ft::tree_iterator<const value_type, node_type> const_iterator;
 		typedef std::size_t												size_type;
 		typedef std::ptrdiff_t											difference_type;
 	
 	private:
-		value_compare	_comp;
+		key_compare		_comp;
 		allocator_type	_alloc;
+		pool_type		_pool;
 		node_pointer	_sentinel;
 		node_pointer	_root;
 		size_type		_size;
 
 	public:
 		/* constructor */
-		tree(const value_compare& comp, const allocator_type& alloc)
-		: _comp(comp), _alloc(alloc), _root(NULL), _size(0)
+		tree(const key_compare& comp, const allocator_type& alloc)
+		: _comp(comp), _alloc(alloc), _pool(alloc), _root(NULL), _size(0)
 		{
-			_sentinel = _alloc.allocate(1);
-			_alloc.construct(_sentinel, node_type());
-			_sentinel->is_sentinel = true;
+			_sentinel = create_sentinel();
 		}
 
 		tree(const tree& other)
-		: _comp(other._comp), _alloc(other._alloc), _root(NULL), _size(0)
+		: _comp(other._comp), _alloc(other._alloc), _pool(other._pool), _root(NULL), _size(0)
 		{
-			_sentinel = _alloc.allocate(1);
-			_alloc.construct(_sentinel, node_type());
-			insert(other.begin(), other.end());
-			_sentinel->is_sentinel = true;
+			_sentinel = create_sentinel();
+			try
+			{
+				copy_from(other, NULL);
+			}
+			catch (...)
+			{
+				_alloc.destroy(_sentinel);
+				_alloc.deallocate(_sentinel, 1);
+				throw ;
+			}
 		}
 
 		/* destructor */
@@ -80,38 +112,41 @@ namespace ft
 		/* assignment operator */
 		tree& operator=(const tree& t)
 		{
+			node_pointer reuse = NULL;
+
 			if (this != &t)
 			{
-				clear();
-				insert(t.begin(), t.end());
+				collect_nodes(_root, reuse);
+				set_root(NULL);
+				_size = 0;
+				copy_from(t, reuse);
 			}
 			return *this;
 		}
 
-		/* iterators */
-		iterator		begin()
+#if __cplusplus >= 201103L
+		// other keeps a fresh empty tree, no node is touched
+		tree(tree&& other)
+		: _comp(other._comp), _alloc(other._alloc), _pool(other._alloc), _root(NULL), _size(0)
 		{
-			node_pointer node;
-
-			if(_size == 0)
-				return iterator(_sentinel);
-			node = _root;
-			while (node->left)
-				node = node->left;
-			return iterator(node);
+			_sentinel = create_sentinel();
+			swap(other);
 		}
 
-		const_iterator	begin() const
+		tree& operator=(tree&& t)
 		{
-			node_pointer node;
-
-			if(_size == 0)
-				return const_iterator(_sentinel);
-			node = _root;
-			while (node->left)
-				node = node->left;
-			return const_iterator(node);
+			if (this != &t)
+			{
+				clear();
+				swap(t);
+			}
+			return *this;
 		}
+#endif
+
+		/* iterators */
+		iterator		begin() { return iterator(_size == 0 ? _sentinel : leftmost()); }
+		const_iterator	begin() const { return const_iterator(_size == 0 ? _sentinel : leftmost()); }
 
 		iterator		end() { return iterator(_sentinel); }
 		const_iterator	end() const { return const_iterator(_sentinel); }
@@ -127,34 +162,201 @@ namespace ft
 		/* modifiers */
 		ft::pair<iterator, bool> insert(const value_type& val)
 		{
-			node_pointer node;
+			node_pointer parent;
+			bool		 is_left;
+			node_pointer node = find_unique_position(key_of_value()(val), parent, is_left);
 
-			if (_size == 0)
-			{
-				set_root(val);
-				return ft::make_pair(iterator(_root), true);
-			}
-			iterator it = find(val);
-			if (it != end())
-				return ft::make_pair(it, false);
-			node = insert_node(val);
-			insert_rebalance(node->parent);
+			if (node)
+				return ft::make_pair(iterator(node), false);
+			node = link_node(create_node(val), parent, is_left);
+			return ft::make_pair(iterator(node), true);
+		}
+
+		// single descent on a bare key, make() is only called when the key is missing, so the value is never
+		// built just to be thrown away.
+		template <typename K, typename Maker>
+		ft::pair<iterator, bool> try_emplace(const K& k, const Maker& make)
+		{
+			node_pointer parent;
+			bool		 is_left;
+			node_pointer node = find_unique_position(k, parent, is_left);
+
+			if (node)
+				return ft::make_pair(iterator(node), false);
+			node = link_node(create_node(make()), parent, is_left);
 			return ft::make_pair(iterator(node), true);
 		}
 		
+		// links val next to the hint when it belongs right before or after it,
+		// otherwise falls back to a full descent
 		iterator insert(iterator position, const value_type& val)
 		{
-			(void)position;
-			return insert(val).first;
+			const key_type&	k = key_of_value()(val);
+			node_pointer	hint = position.base();
+			node_pointer	near;
+
+			if (_size == 0)
+				return insert(val).first;
+			if (hint == _sentinel)
+			{
+				near = (--position).base();
+				if (_comp(key(near), k))
+					return iterator(link_node(create_node(val), near, false));
+				return insert(val).first;
+			}
+			if (_comp(k, key(hint)))
+			{
+				near = (--position).base();
+				if (near == _sentinel || _comp(key(near), k))
+				{
+					if (!hint->left)
+						return iterator(link_node(create_node(val), hint, true));
+					return iterator(link_node(create_node(val), near, false));
+				}
+				return insert(val).first;
+			}
+			if (_comp(key(hint), k))
+			{
+				near = (++position).base();
+				if (near == _sentinel || _comp(k, key(near)))
+				{
+					if (!hint->right)
+						return iterator(link_node(create_node(val), hint, false));
+					return iterator(link_node(create_node(val), near, true));
+				}
+				return insert(val).first;
+			}
+			return iterator(hint);
 		}
 
+		// an empty tree fed a strictly increasing forward range is built
+		// bottom-up in one linear pass, anything else goes through the end()
+		// hint so sorted input stays cheap
 		template <typename InputIterator>
 		void insert(InputIterator first, InputIterator last)
 		{
+			typedef typename ft::iterator_traits<InputIterator>::iterator_category	category;
+
+			if (_size == 0 && build_sorted(first, last, category()))
+				return ;
 			for (InputIterator it = first; it != last; it++)
-				insert(*it);
+				insert(end(), *it);
+		}
+
+#if __cplusplus >= 201103L
+		ft::pair<iterator, bool> insert(value_type&& val)
+		{
+			node_pointer parent;
+			bool		 is_left;
+			node_pointer node = find_unique_position(key_of_value()(val), parent, is_left);
+
+			if (node)
+				return ft::make_pair(iterator(node), false);
+			node = link_node(create_node(std::move(val)), parent, is_left);
+			return ft::make_pair(iterator(node), true);
 		}
 
+		// the key is only known once the value is built, so a value whose key
+		// is already there is built and dropped again
+		template <typename... Args>
+		ft::pair<iterator, bool> emplace(Args&&... args)
+		{
+			node_pointer parent;
+			bool		 is_left;
+			node_pointer node = create_node(std::forward<Args>(args)...);
+			node_pointer found = find_unique_position(key_of_value()(node->value), parent, is_left);
+
+			if (found)
+			{
+				destroy_node(node);
+				return ft::make_pair(iterator(found), false);
+			}
+			return ft::make_pair(iterator(link_node(node, parent, is_left)), true);
+		}
+#endif
+
+		/* duplicate keys */
+		// for the multi containers: val goes after the keys equal to it,
+		// so equal keys keep their insertion order
+		iterator insert_equal(const value_type& val)
+		{
+			node_pointer parent;
+			bool		 is_left;
+
+			find_equal_position(key_of_value()(val), parent, is_left);
+			return iterator(link_node(create_node(val), parent, is_left));
+		}
+
+		// val goes right before the hint, or right after it when the hint
+		// is less, whenever it fits there. Otherwise the same fallback as
+		// std::multimap: after the keys equal to val, or before them when
+		// the hint was less
+		iterator insert_equal(iterator position, const value_type& val)
+		{
+			const key_type&	k = key_of_value()(val);
+			node_pointer	hint = position.base();
+			node_pointer	near;
+			node_pointer	parent;
+			bool			is_left;
+
+			if (_size == 0)
+				return insert_equal(val);
+			if (hint == _sentinel)
+			{
+				if (!_comp(k, key(rightmost())))
+					return iterator(link_node(create_node(val), rightmost(), false));
+				return insert_equal(val);
+			}
+			if (!_comp(key(hint), k))
+			{
+				near = (--position).base();
+				if (near == _sentinel || !_comp(k, key(near)))
+				{
+					if (!hint->left)
+						return iterator(link_node(create_node(val), hint, true));
+					return iterator(link_node(create_node(val), near, false));
+				}
+				return insert_equal(val);
+			}
+			near = (++position).base();
+			if (near == _sentinel || !_comp(key(near), k))
+			{
+				if (!hint->right)
+					return iterator(link_node(create_node(val), hint, false));
+				return iterator(link_node(create_node(val), near, true));
+			}
+			find_equal_position(k, parent, is_left, true);
+			return iterator(link_node(create_node(val), parent, is_left));
+		}
+
+		template <typename InputIterator>
+		void insert_equal(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert_equal(end(), *first);
+		}
+
+		// the first of the keys equal to k
+		template <typename K>
+		iterator		find_equal(const K& k) { return iterator(exact_node(lower_bound_node(k), k)); }
+		template <typename K>
+		const_iterator	find_equal(const K& k) const { return const_iterator(exact_node(lower_bound_node(k), k)); }
+
+		// O(log n + count)
+		template <typename K>
+		size_type		count_equal(const K& k) const
+		{
+			node_pointer	node = exact_node(lower_bound_node(k), k);
+			size_type		n = 0;
+
+			for (const_iterator it(node); node != _sentinel && !_comp(k, key(node)); node = (++it).base())
+				++n;
+			return n;
+		}
+
+		template <typename K>
+		size_type		erase_equal(const K& k) { return erase(lower_bound(k), upper_bound(k)); }
+
 		size_type erase(iterator position)
 		{
 			node_pointer node;
@@ -162,29 +364,74 @@ namespace ft
 
 			if (_size == 0 || position == end())
 				return 0;
-			for (ancestor = position.base(); ancestor->parent; ancestor = ancestor->parent) {}
+			for (ancestor = position.base(); !ancestor->is_sentinel; ancestor = ancestor->parent) {}
 			if (ancestor != _sentinel)
 				return 0;
 			node = position.base();
+			if (_size == 1)
+			{
+				leftmost() = NULL;
+				rightmost() = NULL;
+			}
+			else if (node == leftmost())
+				leftmost() = (++iterator(node)).base();
+			else if (node == rightmost())
+				rightmost() = (--iterator(node)).base();
 			if (!node->left && !node->right)
 				node = delete_node_leaf(node);
 			else if (node->left && node->right)
 				node = delete_node_2child(node);
 			else
 				node = delete_node_1child(node);
+			propagate(node);
 			erase_rebalance(node);
 			return 1;
 		}
 
-		void erase(iterator first, iterator last)
-		{	
-			for (iterator it = first; it != last;)
-				erase(it++);
+		// cuts [first, last) out with two splits and puts the rest back with
+		// one join: O(k + log n) instead of k single erases
+		size_type erase(iterator first, iterator last)
+		{
+			node_pointer	left;
+			node_pointer	middle;
+			node_pointer	right;
+			node_pointer	ancestor;
+			size_type		n;
+
+			if (first == last)
+				return 0;
+			for (ancestor = first.base(); !ancestor->is_sentinel; ancestor = ancestor->parent) {}
+			if (ancestor != _sentinel)
+				return 0;
+			if (first.base() == leftmost() && last.base() == _sentinel)
+			{
+				n = _size;
+				clear();
+				return n;
+			}
+			_root->parent = NULL;
+			split(first.base(), left, middle);
+			destroy_node(first.base());
+			n = 1;
+			if (last.base() == _sentinel)
+			{
+				n += destroy_subtree(middle);
+				set_root(left);
+			}
+			else
+			{
+				split(last.base(), middle, right);
+				n += destroy_subtree(middle);
+				set_root(join(left, last.base(), right));
+			}
+			_size -= n;
+			reset_extremes();
+			return n;
 		}
 
 		void swap(tree& x)
 		{
-			value_compare	tmp_comp = _comp;
+			key_compare		tmp_comp = _comp;
 			allocator_type	tmp_alloc = _alloc;
 			node_pointer	tmp_sentinel = _sentinel;
 			node_pointer	tmp_root = _root;
@@ -201,116 +448,397 @@ namespace ft
 			x._sentinel = tmp_sentinel;
 			x._root = tmp_root;
 			x._size = tmp_size;
+
+			_pool.swap(x._pool);
 		}
 
 		void clear()
 		{
+			bool bulk;
+
 			if (_size == 0)
 				return ;
-			destroy(_root);
-			_sentinel->left = NULL;
-			_sentinel->right = NULL;
-			_root = NULL;
+			bulk = _pool.exclusive();
+			if (!bulk || !ft::is_trivially_destructible<node_type>::value)
+				destroy(_root, !bulk);
+			if (bulk)
+				_pool.release();
+			set_root(NULL);
+			reset_extremes();
 			_size = 0;
 		}
 
-		/* operations */
-		iterator		find(const value_type& val)
+		/* split & join */
+		// moves every element not less than k into x, whose old content is
+		// dropped. Nodes change trees as they are, both pools share their
+		// slabs from then on. The split itself is O(log n), the size of the
+		// moved part is counted with a walk unless the NodeUpdate tracks it
+		template <typename K>
+		void split(const K& k, tree& x)
 		{
-			node_pointer node;
+			node_pointer	left;
+			node_pointer	found;
+			node_pointer	right;
+			size_type		n;
 
+			if (this == &x)
+				return ;
+			x.clear();
 			if (_size == 0)
-				return end();
-			node = _root;
+				return ;
+			_root->parent = NULL;
+			split_key(_root, k, left, found, right);
+			if (found)
+				right = join(NULL, found, right);
+			n = subtree_size(right, typename node_update::tracks_size());
+			if (n != 0)
+				_pool.share(x._pool);
+			set_root(left);
+			reset_extremes();
+			_size -= n;
+			x.set_root(right);
+			x.reset_extremes();
+			x._size = n;
+		}
+
+		// appends pivot then every element of x, x ends up empty. Costs the
+		// height difference when pivot sits between the two trees, falls back
+		// to merge() when it does not
+		void join(const value_type& pivot, tree& x)
+		{
+			const key_type&	k = key_of_value()(pivot);
+			node_pointer	right;
+
+			if (this == &x)
+				return ;
+			if ((_size != 0 && !_comp(key(rightmost()), k))
+				|| (x._size != 0 && !_comp(k, key(x.leftmost()))))
+			{
+				insert(pivot);
+				merge(x);
+				return ;
+			}
+			right = x._root;
+			if (right)
+			{
+				_pool.share(x._pool);
+				right->parent = NULL;
+			}
+			if (_root)
+				_root->parent = NULL;
+			set_root(join(_root, create_node(pivot), right));
+			_size += x._size + 1;
+			reset_extremes();
+			x.set_root(NULL);
+			x.reset_extremes();
+			x._size = 0;
+		}
+
+		// same with the minimum of x as the pivot
+		void join(tree& x)
+		{
+			node_pointer	pivot;
+			node_pointer	left;
+			node_pointer	right;
+
+			if (this == &x || x._size == 0)
+				return ;
+			if (_size != 0 && !_comp(key(rightmost()), key(x.leftmost())))
+			{
+				merge(x);
+				return ;
+			}
+			_pool.share(x._pool);
+			pivot = x.leftmost();
+			x._root->parent = NULL;
+			x.split(pivot, left, right);
+			if (_root)
+				_root->parent = NULL;
+			set_root(join(_root, pivot, right));
+			_size += x._size;
+			reset_extremes();
+			x.set_root(NULL);
+			x.reset_extremes();
+			x._size = 0;
+		}
+
+		// splices every node of x whose key is not here yet, the others stay
+		// in x. Divide and conquer: split this tree around the root of x,
+		// merge both halves and join them back over that root, which is
+		// O(m log(n/m + 1)) for m <= n instead of m independent inserts
+		void merge(tree& x)
+		{
+			node_pointer	dups = NULL;
+			node_pointer	next;
+			size_type		n = 0;
+
+			if (this == &x || x._size == 0)
+				return ;
+			_pool.share(x._pool);
+			if (_root)
+				_root->parent = NULL;
+			x._root->parent = NULL;
+			set_root(union_subtrees(_root, x._root, dups, n));
+			_size += x._size - n;
+			reset_extremes();
+			x.set_root(NULL);
+			x.reset_extremes();
+			x._size = 0;
+			for (; dups; dups = next)
+			{
+				next = dups->parent;
+				x.relink_node(dups);
+			}
+		}
+
+		/* operations */
+		// every lookup is keyed: K is key_type, or anything the comparator
+		// accepts against it when it is transparent
+		template <typename K>
+		iterator		find(const K& key) { return iterator(find_node(key)); }
+		template <typename K>
+		const_iterator	find(const K& key) const { return const_iterator(find_node(key)); }
+
+		template <typename K>
+		size_type		count(const K& key) const { return find_node(key) == _sentinel ? 0 : 1; }
+
+		template <typename K>
+		iterator		lower_bound(const K& key) { return iterator(lower_bound_node(key)); }
+		template <typename K>
+		const_iterator	lower_bound(const K& key) const { return const_iterator(lower_bound_node(key)); }
+
+		template <typename K>
+		iterator		upper_bound(const K& key) { return iterator(upper_bound_node(key)); }
+		template <typename K>
+		const_iterator	upper_bound(const K& key) const { return const_iterator(upper_bound_node(key)); }
+
+		template <typename K>
+		ft::pair<iterator, iterator> equal_range(const K& key)
+		{ return ft::make_pair(lower_bound(key), upper_bound(key)); }
+		template <typename K>
+		ft::pair<const_iterator, const_iterator> equal_range(const K& key) const
+		{ return ft::make_pair(lower_bound(key), upper_bound(key)); }
+
+		/* finger search */
+		// the search climbs from the hint only until the subtree it is in
+		// holds the answer, then goes down that subtree. The cost follows the
+		// height of the ancestor it stops at: small for a nearby key, but up
+		// to the tree height when the two sides only meet far above, even
+		// for the next key. The hint is any iterator of this tree, end()
+		// included
+		template <typename K>
+		iterator		find(const_iterator hint, const K& k) { return iterator(exact_node(lower_bound_node(hint.base(), k), k)); }
+		template <typename K>
+		const_iterator	find(const_iterator hint, const K& k) const { return const_iterator(exact_node(lower_bound_node(hint.base(), k), k)); }
+
+		template <typename K>
+		iterator		lower_bound(const_iterator hint, const K& k) { return iterator(lower_bound_node(hint.base(), k)); }
+		template <typename K>
+		const_iterator	lower_bound(const_iterator hint, const K& k) const { return const_iterator(lower_bound_node(hint.base(), k)); }
+
+		/* batched lookups */
+		// out[i] gets the node of keys[i], or end(). Iterator is iterator or
+		// const_iterator, the map only hands out the one its constness allows
+		template <typename K, typename Iterator>
+		void	find_many(const K* keys, size_type n, Iterator* out) const
+		{ bound_many<true>(keys, n, out); }
+
+		template <typename K, typename Iterator>
+		void	lower_bound_many(const K* keys, size_type n, Iterator* out) const
+		{ bound_many<false>(keys, n, out); }
+
+		/* order statistics */
+		// these need ft::order_statistics_node_update as NodeUpdate
+		iterator		find_by_order(size_type n) { return iterator(select_node(n)); }
+		const_iterator	find_by_order(size_type n) const { return const_iterator(select_node(n)); }
+
+		// number of keys strictly less than k
+		template <typename K>
+		size_type		order_of_key(const K& k) const
+		{
+			node_pointer	node = _root;
+			size_type		rank = 0;
+
 			while (node)
 			{
-				if (_comp(val, node->value))
-					node = node->left;
-				else if (_comp(node->value, val))
+				if (_comp(key(node), k))
+				{
+					rank += node_update::size(node->left) + 1;
 					node = node->right;
+				}
 				else
-					return iterator(node);
+					node = node->left;
 			}
-			return end();
+			return rank;
 		}
 
-		const_iterator	find(const value_type& val) const
+		// position of an iterator, size() for end()
+		size_type		order_of(const_iterator position) const
 		{
-			node_pointer node;
+			node_pointer	node = position.base();
+			size_type		rank;
 
-			if (_size == 0)
-				return end();
-			node = _root;
-			while (node)
+			if (node == _sentinel)
+				return _size;
+			rank = node_update::size(node->left);
+			for (; node->parent != _sentinel; node = node->parent)
+			{
+				if (node->parent->right == node)
+					rank += node_update::size(node->parent->left) + 1;
+			}
+			return rank;
+		}
+
+		/* aggregates */
+		// these need ft::aggregate_node_update as NodeUpdate. The summary of
+		// the keys in [lo, hi): the subtrees hanging off the two paths from
+		// the node where lo and hi part, combined in key order
+		template <typename K>
+		typename node_update::metadata_type	aggregate(const K& lo, const K& hi) const
+		{
+			typedef typename node_update::monoid_type	monoid;
+
+			typename node_update::metadata_type	left = monoid::identity();
+			typename node_update::metadata_type	right = monoid::identity();
+			node_pointer						split = _root;
+			node_pointer						node;
+
+			while (split && (_comp(key(split), lo) || !_comp(key(split), hi)))
+				split = _comp(key(split), lo) ? split->right : split->left;
+			if (!split)
+				return left;
+			for (node = split->left; node; )
 			{
-				if (_comp(val, node->value))
+				if (_comp(key(node), lo))
+					node = node->right;
+				else
+				{
+					left = monoid::combine(monoid::combine(monoid::lift(node->value), node_update::summary(node->right)), left);
 					node = node->left;
-				else if (_comp(node->value, val))
+				}
+			}
+			for (node = split->right; node; )
+			{
+				if (_comp(key(node), hi))
+				{
+					right = monoid::combine(right, monoid::combine(node_update::summary(node->left), monoid::lift(node->value)));
 					node = node->right;
+				}
 				else
-					return const_iterator(node);
+					node = node->left;
 			}
-			return end();
+			return monoid::combine(monoid::combine(left, monoid::lift(split->value)), right);
 		}
 
-		 size_type		count(const value_type& val) const
-		 {
-			 if (find(val) == end())
-			 	return 0;
-			return 1;
-		 }
+		// call after changing the value at position in place, so the
+		// metadata above it follows
+		void	refresh(iterator position) { propagate(position.base()); }
+
+		/* observers */
+		key_compare	key_comp() const { return _comp; }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		/* private memeber function */
+		static const key_type&	key(node_pointer node) { return key_of_value()(node->value); }
 
-		iterator		lower_bound(const value_type& val)
+		template <typename K>
+		node_pointer	find_node(const K& k) const
 		{
-			node_pointer res = _sentinel;
-			node_pointer node;
+			node_pointer node = _root;
 
-			node = _root;
 			while (node)
 			{
-				if (_comp(val, node->value))
-				{
-					res = node;
+				if (_comp(k, key(node)))
 					node = node->left;
-				}
-				else if (_comp(node->value, val))
+				else if (_comp(key(node), k))
 					node = node->right;
 				else
-					return iterator(node);
+					return node;
 			}
-			return iterator(res);
+			return _sentinel;
 		}
 
-		const_iterator		lower_bound(const value_type& val) const
+		node_pointer	select_node(size_type n) const
+		{
+			node_pointer	node = _root;
+			size_type		left;
+
+			if (n >= _size)
+				return _sentinel;
+			while (node)
+			{
+				left = node_update::size(node->left);
+				if (n < left)
+					node = node->left;
+				else if (n == left)
+					break ;
+				else
+				{
+					n -= left + 1;
+					node = node->right;
+				}
+			}
+			return node;
+		}
+
+		template <typename K>
+		node_pointer	lower_bound_node(const K& k) const
 		{
 			node_pointer res = _sentinel;
-			node_pointer node;
+			node_pointer node = _root;
 
-			node = _root;
 			while (node)
 			{
-				if (_comp(val, node->value))
+				if (!_comp(key(node), k))
 				{
 					res = node;
 					node = node->left;
 				}
-				else if (_comp(node->value, val))
-					node = node->right;
 				else
-					return const_iterator(node);
+					node = node->right;
 			}
-			return const_iterator(res);
+			return res;
 		}
 
-		iterator		upper_bound(const value_type& val)
+		// past a key below k the climb stops at the first ancestor it
+		// comes from the left of whose key is not below k: the answer is
+		// that one or under it. Before a key not below k it stops at the
+		// first ancestor it comes from the right of whose key is below k,
+		// the hint is under it and so is the answer
+		template <typename K>
+		node_pointer	lower_bound_node(node_pointer hint, const K& k) const
 		{
-			node_pointer res = _sentinel;
-			node_pointer node;
+			node_pointer	res = _sentinel;
+			node_pointer	node = hint;
+			node_pointer	parent;
+			bool			rightward;
 
-			node = _root;
+			if (_size == 0)
+				return _sentinel;
+			if (node == _sentinel)
+			{
+				node = rightmost();
+				if (_comp(key(node), k))
+					return _sentinel;
+			}
+			rightward = _comp(key(node), k);
+			for (parent = node->parent; parent != _sentinel; parent = node->parent)
+			{
+				if (rightward && parent->left == node && !_comp(key(parent), k))
+				{
+					res = parent;
+					break ;
+				}
+				if (!rightward && parent->right == node && _comp(key(parent), k))
+					break ;
+				node = parent;
+			}
 			while (node)
 			{
-				if (_comp(val, node->value))
+				if (!_comp(key(node), k))
 				{
 					res = node;
 					node = node->left;
@@ -318,18 +846,18 @@ namespace ft
 				else
 					node = node->right;
 			}
-			return iterator(res);
+			return res;
 		}
 
-		const_iterator		upper_bound(const value_type& val) const
+		template <typename K>
+		node_pointer	upper_bound_node(const K& k) const
 		{
 			node_pointer res = _sentinel;
-			node_pointer node;
+			node_pointer node = _root;
 
-			node = _root;
 			while (node)
 			{
-				if (_comp(val, node->value))
+				if (_comp(k, key(node)))
 				{
 					res = node;
 					node = node->left;
@@ -337,63 +865,312 @@ namespace ft
 				else
 					node = node->right;
 			}
-			return const_iterator(res);
+			return res;
 		}
 
-		ft::pair<iterator, iterator> equal_range (const value_type& val)
-		{ return ft::make_pair(lower_bound(val), upper_bound(val)); }
+		/* batched lookups */
+		// descents of one batch advance a level per round, each lane asks
+		// for its next node before the others use theirs, so the misses of
+		// a round overlap instead of following each other
+		static const size_type	batch_lanes = 16;
+		// a sorted batch steps on from the previous answer as long as the
+		// next key is at most this many nodes further
+		static const size_type	finger_steps = 8;
 
-		ft::pair<const_iterator, const_iterator> equal_range (const value_type& val) const
-		{ return ft::make_pair(lower_bound(val), upper_bound(val)); }
+		static void	prefetch(node_pointer node)
+		{
+#if defined(__GNUC__)
+			__builtin_prefetch(node);
+#else
+			(void)node;
+#endif
+		}
 
-		/* allocator */
-		allocator_type get_allocator() const { return _alloc; }
+		template <bool Exact, typename K, typename Iterator>
+		void	bound_many(const K* keys, size_type n, Iterator* out) const
+		{
+			node_pointer	node[batch_lanes];
+			node_pointer	res[batch_lanes];
+			size_type		lanes;
+			size_type		active;
 
-	private:
-		/* private memeber function */
-		void	set_root(const value_type& val)
+			for (size_type base = n && is_sorted_batch(keys, n) ? finger_many<Exact>(keys, n, out) : 0; base < n; base += lanes)
+			{
+				lanes = n - base < batch_lanes ? n - base : batch_lanes;
+				for (size_type i = 0; i < lanes; ++i)
+				{
+					node[i] = _root;
+					res[i] = _sentinel;
+				}
+				for (active = lanes; active; )
+				{
+					active = 0;
+					for (size_type i = 0; i < lanes; ++i)
+					{
+						if (!node[i])
+							continue ;
+						if (!_comp(key(node[i]), keys[base + i]))
+						{
+							res[i] = node[i];
+							node[i] = node[i]->left;
+						}
+						else
+							node[i] = node[i]->right;
+						if (node[i])
+						{
+							prefetch(node[i]);
+							++active;
+						}
+					}
+				}
+				for (size_type i = 0; i < lanes; ++i)
+					out[base + i] = Iterator(Exact ? exact_node(res[i], keys[base + i]) : res[i]);
+			}
+		}
+
+		// answers keys in order while each one is a few steps past the one
+		// before, returns where the keys got too sparse for that
+		template <bool Exact, typename K, typename Iterator>
+		size_type	finger_many(const K* keys, size_type n, Iterator* out) const
 		{
-			_root = _alloc.allocate(1);
-			_alloc.construct(_root, node_type(val));
-			_sentinel->left = _root;
-			_sentinel->right = _root;
-			_root->parent = _sentinel;
-			++_size;
+			node_pointer	res = lower_bound_node(keys[0]);
+			size_type		steps;
+
+			for (size_type i = 0; i < n; ++i)
+			{
+				for (steps = 0; res != _sentinel && _comp(key(res), keys[i]); ++steps)
+				{
+					if (steps == finger_steps)
+						return i;
+					res = (++const_iterator(res)).base();
+				}
+				out[i] = Iterator(Exact ? exact_node(res, keys[i]) : res);
+			}
+			return n;
+		}
+
+		template <typename K>
+		bool	is_sorted_batch(const K* keys, size_type n) const
+		{
+			for (size_type i = 1; i < n; ++i)
+			{
+				if (_comp(keys[i], keys[i - 1]))
+					return false;
+			}
+			return true;
+		}
+
+		template <typename K>
+		node_pointer	exact_node(node_pointer node, const K& k) const
+		{ return (node != _sentinel && !_comp(k, key(node))) ? node : _sentinel; }
+
+		// the sentinel links the root through left, which also ends iteration,
+		// and caches the minimum in parent and the maximum in right
+		void	set_root(node_pointer root)
+		{
+			_root = root;
+			if (root)
+				root->parent = _sentinel;
+			_sentinel->left = root;
+		}
+
+		node_pointer&	leftmost() const { return _sentinel->parent; }
+		node_pointer&	rightmost() const { return _sentinel->right; }
+
+		void	reset_extremes()
+		{
+			node_pointer node = _root;
+
+			leftmost() = NULL;
+			rightmost() = NULL;
+			if (!node)
+				return ;
+			while (node->left)
+				node = node->left;
+			leftmost() = node;
+			for (node = _root; node->right; node = node->right) {}
+			rightmost() = node;
+		}
+
+		// hangs child where old was below parent, parent is NULL at the top of a
+		// detached subtree
+		void	replace_child(node_pointer parent, node_pointer old, node_pointer child)
+		{
+			if (parent == _sentinel)
+				set_root(child);
+			else if (parent && parent->left == old)
+				parent->left = child;
+			else if (parent)
+				parent->right = child;
+			if (child)
+				child->parent = parent;
+		}
+
+#if __cplusplus >= 201103L
+		template <typename... Args>
+		node_pointer	create_node(Args&&... args)
+		{
+			node_pointer node = _pool.allocate();
+
+			try
+			{
+				_alloc.construct(node, typename node_type::emplace_tag(), std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				_pool.deallocate(node);
+				throw ;
+			}
+			return node;
 		}
+#else
+		node_pointer	create_node(const value_type& val)
+		{
+			node_pointer node = _pool.allocate();
 
-		node_pointer insert_node(const value_type& val)
+			try
+			{
+				_alloc.construct(node, node_type(val));
+			}
+			catch (...)
+			{
+				_pool.deallocate(node);
+				throw ;
+			}
+			return node;
+		}
+#endif
+
+		template <typename InputIterator>
+		bool	build_sorted(InputIterator, InputIterator, std::input_iterator_tag)
+		{ return false; }
+
+		template <typename ForwardIterator>
+		bool	build_sorted(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+		{
+			ForwardIterator	prev = first;
+			ForwardIterator	it = first;
+			size_type		n = 1;
+
+			if (first == last)
+				return true;
+			for (++it; it != last; prev = it++, ++n)
+			{
+				if (!_comp(key_of_value()(*prev), key_of_value()(*it)))
+					return false;
+			}
+			set_root(build_subtree(first, n));
+			reset_extremes();
+			_size = n;
+			return true;
+		}
+
+		// in-order consumption of n values from it: the middle one becomes the
+		// root, so both sides differ by at most one node
+		template <typename ForwardIterator>
+		node_pointer	build_subtree(ForwardIterator& it, size_type n)
 		{
 			node_pointer node;
-			node_pointer tmp;
+			node_pointer left;
+
+			if (n == 0)
+				return NULL;
+			left = build_subtree(it, n / 2);
+			node = create_node(*it);
+			++it;
+			node->left = left;
+			if (left)
+				left->parent = node;
+			node->right = build_subtree(it, n - n / 2 - 1);
+			if (node->right)
+				node->right->parent = node;
+			update_height(node);
+			node_update::update(node);
+			return node;
+		}
+
+		// walks down once: returns the node equal to k, or NULL with the
+		// parent and side where key has to be linked. Keys past the cached
+		// maximum, like increasing timestamps, skip the descent entirely
+		template <typename K>
+		node_pointer	find_unique_position(const K& k, node_pointer& parent, bool& is_left)
+		{
+			node_pointer node = _root;
 
-			node = _alloc.allocate(1);
-			_alloc.construct(node, node_type(val));
-			tmp = _root;
-			while (tmp)
+			parent = _sentinel;
+			is_left = true;
+			if (_size != 0 && _comp(key(rightmost()), k))
 			{
-				if (_comp(val, tmp->value))
+				parent = rightmost();
+				is_left = false;
+				return NULL;
+			}
+			while (node)
+			{
+				parent = node;
+				if (_comp(k, key(node)))
 				{
-					if (tmp->left)
-						tmp = tmp->left;
-					else
-					{
-						tmp->left = node;
-						break ;
-					}
+					is_left = true;
+					node = node->left;
 				}
-				else if (_comp(tmp->value, val))
+				else if (_comp(key(node), k))
 				{
-					if (tmp->right)
-						tmp = tmp->right;
-					else
-					{
-						tmp->right = node;
-						break ;
-					}
+					is_left = false;
+					node = node->right;
 				}
+				else
+					return node;
+			}
+			return NULL;
+		}
+
+		// where a key goes after the keys equal to it, or before them
+		template <typename K>
+		void	find_equal_position(const K& k, node_pointer& parent, bool& is_left, bool before = false) const
+		{
+			node_pointer node = _root;
+
+			parent = _sentinel;
+			is_left = true;
+			if (_size != 0 && (before ? _comp(key(rightmost()), k) : !_comp(k, key(rightmost()))))
+			{
+				parent = rightmost();
+				is_left = false;
+				return ;
+			}
+			while (node)
+			{
+				parent = node;
+				is_left = before ? !_comp(key(node), k) : _comp(k, key(node));
+				node = is_left ? node->left : node->right;
+			}
+		}
+
+		node_pointer	link_node(node_pointer node, node_pointer parent, bool is_left)
+		{
+			node->parent = parent;
+			if (parent == _sentinel)
+			{
+				set_root(node);
+				leftmost() = node;
+				rightmost() = node;
+			}
+			else if (is_left)
+			{
+				parent->left = node;
+				if (parent == leftmost())
+					leftmost() = node;
+			}
+			else
+			{
+				parent->right = node;
+				if (parent == rightmost())
+					rightmost() = node;
 			}
-			node->parent = tmp;
 			++_size;
+			node_update::update(node);
+			propagate(parent);
+			insert_rebalance(parent);
 			return node;
 		}
 		
@@ -401,19 +1178,8 @@ namespace ft
 		{
 			node_pointer parent = node->parent;
 
-			if (parent->left == node)
-				parent->left = NULL;
-			else
-				parent->right = NULL;
-			
-			if (node == _root)
-			{
-				_root = NULL;
-				_sentinel->left = NULL;
-				_sentinel->right = NULL;
-			}
-			_alloc.destroy(node);
-			_alloc.deallocate(node, 1);
+			replace_child(parent, node, NULL);
+			destroy_node(node);
 			--_size;
 			return parent;
 		}
@@ -423,33 +1189,26 @@ namespace ft
 			node_pointer parent = node->parent;
 			node_pointer child = node->left ? node->left : node->right;
 
-			if (parent->left == node)
-				parent->left = child;
-			else
-				parent->right = child;
-			child->parent = parent;
-			
-			if (node == _root)
-			{
-				_root = child;
-				_sentinel->left = child;
-				_sentinel->right = child;
-			}
-			_alloc.destroy(node);
-			_alloc.deallocate(node, 1);
+			replace_child(parent, node, child);
+			destroy_node(node);
 			--_size;
 			return parent;
 		}
 		
+		// returns the deepest node whose subtree lost height: the old parent of the
+		// successor, or the successor itself when it was the right child.
 		node_pointer delete_node_2child(const node_pointer& node)
 		{
 			node_pointer parent = node->parent;
 			node_pointer alter;
+			node_pointer retrace;
 
 			for (alter = node->right; alter->left; alter = alter->left) {}
 			
+			retrace = alter;
 			if (alter != node->right)
 			{
+				retrace = alter->parent;
 				alter->parent->left = alter->right;
 				if (alter->right)
 					alter->right->parent = alter->parent;
@@ -457,61 +1216,36 @@ namespace ft
 				alter->right = node->right;
 				node->right->parent = alter;
 			}
-
-			if (parent->left == node)
-				parent->left = alter;
-			else
-				parent->right = alter;
-			alter->parent = parent;
+			alter->height = node->height;
+			replace_child(parent, node, alter);
 
 			alter->left = node->left;
 			node->left->parent = alter;
-			
-			if (node == _root)
-			{
-				_root = alter;
-				_sentinel->left = alter;
-				_sentinel->right = alter;
-			}
-			_alloc.destroy(node);
-			_alloc.deallocate(node, 1);
+			destroy_node(node);
 			--_size;
-			return parent;
+			return retrace;
 		}
 
-		int		get_height(node_pointer node)
-		{
-			int left;
-			int right;
-
-			if (!node)
-				return -1;
-			left = get_height(node->left) + 1;
-			right = get_height(node->right) + 1;
-			return (left > right ? left : right);
-		}
+		int		get_height(node_pointer node) const { return node ? node->height : -1; }
 
-		int		balance_factor(node_pointer node)
+		void	update_height(node_pointer node)
 		{
-			int left;
-			int right;
+			int left = get_height(node->left);
+			int right = get_height(node->right);
 
-			left = get_height(node->left);
-			right = get_height(node->right);
-			return (left - right);
+			node->height = (left > right ? left : right) + 1;
 		}
 
-		void	rotate_ll(node_pointer node)
+		int		balance_factor(node_pointer node) const
+		{ return get_height(node->left) - get_height(node->right); }
+
+		node_pointer	rotate_ll(node_pointer node)
 		{
 			node_pointer parent = node->parent;
 			node_pointer left = node->left;
 			node_pointer left_right = node->left->right;
 
-			if (parent->right == node)
-				parent->right = left;
-			else
-				parent->left = left;
-			left->parent = parent;
+			replace_child(parent, node, left);
 
 			left->right = node;
 			node->parent = left;
@@ -520,25 +1254,20 @@ namespace ft
 			if (left_right)
 				left_right->parent = node;
 
-			if (node == _root)
-			{
-				_root = left;
-				_sentinel->left = left;
-				_sentinel->right = left;
-			}
+			update_height(node);
+			update_height(left);
+			node_update::update(node);
+			node_update::update(left);
+			return left;
 		}
 
-		void	rotate_rr(node_pointer node)
+		node_pointer	rotate_rr(node_pointer node)
 		{
 			node_pointer parent = node->parent;
 			node_pointer right = node->right;
 			node_pointer right_left = node->right->left;
 
-			if (parent->right == node)
-				parent->right = right;
-			else
-				parent->left = right;
-			right->parent = parent;
+			replace_child(parent, node, right);
 
 			right->left = node;
 			node->parent = right;
@@ -547,70 +1276,401 @@ namespace ft
 			if (right_left)
 				right_left->parent = node;
 
-			if (node == _root)
+			update_height(node);
+			update_height(right);
+			node_update::update(node);
+			node_update::update(right);
+			return right;
+		}
+
+		/* split & join */
+		// these work on detached subtrees, whose root has a NULL parent
+
+		void	attach_pivot(node_pointer pivot, node_pointer left, node_pointer right)
+		{
+			pivot->left = left;
+			if (left)
+				left->parent = pivot;
+			pivot->right = right;
+			if (right)
+				right->parent = pivot;
+			update_height(pivot);
+			node_update::update(pivot);
+		}
+
+		// fixes heights, metadata and balance from node up to the top of its
+		// detached subtree, returns the new top
+		node_pointer	retrace_detached(node_pointer node)
+		{
+			node_pointer top = node;
+
+			while (node)
+			{
+				update_height(node);
+				node_update::update(node);
+				top = rebalance(node);
+				node = top->parent;
+			}
+			return top;
+		}
+
+		// every key of left < pivot < every key of right. The pivot goes down
+		// the spine of the taller side until the heights match, so the cost is
+		// the height difference
+		node_pointer	join(node_pointer left, node_pointer pivot, node_pointer right)
+		{
+			int				hl = get_height(left);
+			int				hr = get_height(right);
+			node_pointer	spine;
+			node_pointer	parent = NULL;
+
+			if (left)
+				left->parent = NULL;
+			if (right)
+				right->parent = NULL;
+			pivot->parent = NULL;
+			if (hl > hr + 1)
 			{
-				_root = right;
-				_sentinel->left = right;
-				_sentinel->right = right;
+				for (spine = left; get_height(spine) > hr + 1; spine = spine->right)
+					parent = spine;
+				attach_pivot(pivot, spine, right);
+				parent->right = pivot;
+				pivot->parent = parent;
+				return retrace_detached(parent);
 			}
+			if (hr > hl + 1)
+			{
+				for (spine = right; get_height(spine) > hl + 1; spine = spine->left)
+					parent = spine;
+				attach_pivot(pivot, left, spine);
+				parent->left = pivot;
+				pivot->parent = parent;
+				return retrace_detached(parent);
+			}
+			attach_pivot(pivot, left, right);
+			return pivot;
+		}
+
+		// cuts the detached tree holding node into the keys before and after
+		// it. Every ancestor is joined back as a pivot on the side it belongs
+		// to, and the height differences telescope to O(log n)
+		void	split(node_pointer node, node_pointer& left, node_pointer& right)
+		{
+			node_pointer child = node;
+			node_pointer parent = node->parent;
+			node_pointer next;
+
+			left = node->left;
+			right = node->right;
+			if (left)
+				left->parent = NULL;
+			if (right)
+				right->parent = NULL;
+			while (parent)
+			{
+				next = parent->parent;
+				if (parent->left == child)
+					right = join(right, parent, parent->right);
+				else
+					left = join(parent->left, parent, left);
+				child = parent;
+				parent = next;
+			}
+			node->parent = NULL;
+			node->left = NULL;
+			node->right = NULL;
+		}
+
+		// cuts a detached tree into the keys below and above k, the node
+		// holding k, if any, comes out alone in found
+		template <typename K>
+		void	split_key(node_pointer node, const K& k, node_pointer& left, node_pointer& found, node_pointer& right)
+		{
+			if (!node)
+			{
+				left = NULL;
+				found = NULL;
+				right = NULL;
+			}
+			else if (_comp(k, key(node)))
+			{
+				split_key(node->left, k, left, found, right);
+				right = join(right, node, node->right);
+			}
+			else if (_comp(key(node), k))
+			{
+				split_key(node->right, k, left, found, right);
+				left = join(node->left, node, left);
+			}
+			else
+			{
+				left = node->left;
+				right = node->right;
+				if (left)
+					left->parent = NULL;
+				if (right)
+					right->parent = NULL;
+				found = node;
+				node->left = NULL;
+				node->right = NULL;
+			}
+		}
+
+		// union of two detached trees, nodes of b whose key is already in a
+		// are threaded into dups through their parent link and counted in n
+		node_pointer	union_subtrees(node_pointer a, node_pointer b, node_pointer& dups, size_type& n)
+		{
+			node_pointer	left;
+			node_pointer	found;
+			node_pointer	right;
+			node_pointer	b_left;
+			node_pointer	b_right;
+
+			if (!a)
+				return b;
+			if (!b)
+				return a;
+			b_left = b->left;
+			b_right = b->right;
+			if (b_left)
+				b_left->parent = NULL;
+			if (b_right)
+				b_right->parent = NULL;
+			split_key(a, key(b), left, found, right);
+			left = union_subtrees(left, b_left, dups, n);
+			right = union_subtrees(right, b_right, dups, n);
+			if (found)
+			{
+				b->parent = dups;
+				dups = b;
+				++n;
+				b = found;
+			}
+			return join(left, b, right);
+		}
+
+		// links a node that left another tree sharing our pool, its key must
+		// not be here yet
+		void	relink_node(node_pointer node)
+		{
+			node_pointer	parent;
+			bool			is_left;
+
+			find_unique_position(key(node), parent, is_left);
+			node->left = NULL;
+			node->right = NULL;
+			node->height = 0;
+			link_node(node, parent, is_left);
+		}
+
+		size_type	subtree_size(node_pointer node, ft::true_type) const { return node_update::size(node); }
+
+		size_type	subtree_size(node_pointer node, ft::false_type) const
+		{
+			if (!node)
+				return 0;
+			return subtree_size(node->left, ft::false_type()) + subtree_size(node->right, ft::false_type()) + 1;
+		}
+
+		// restores the avl property of a subtree whose root is off by two,
+		// returns the new root of the subtree
+		node_pointer	rebalance(node_pointer node)
+		{
+			int bf = balance_factor(node);
+
+			if (bf > 1)
+			{
+				if (balance_factor(node->left) < 0)
+					rotate_rr(node->left);
+				return rotate_ll(node);
+			}
+			if (bf < -1)
+			{
+				if (balance_factor(node->right) > 0)
+					rotate_ll(node->right);
+				return rotate_rr(node);
+			}
+			return node;
+		}
+
+		// refreshes node update metadata from node up to the root; done before
+		// rebalancing so rotations always see up to date children
+		void	propagate(node_pointer node)
+		{
+			if (node_update::null_update)
+				return ;
+			for (; node != _sentinel; node = node->parent)
+				node_update::update(node);
 		}
 
+		// heights are cached in the nodes, so retracing stops as soon as a
+		// subtree keeps its height: one rotation is always enough on insert
 		void	insert_rebalance(node_pointer node)
 		{
-			int bf;
+			int old_height;
 
 			while (node != _sentinel)
 			{
-				bf = balance_factor(node);
-				if (bf > 1)
+				old_height = node->height;
+				update_height(node);
+				if (balance_factor(node) > 1 || balance_factor(node) < -1)
 				{
-					if (balance_factor(node->left) < 0)
-						rotate_rr(node->left);
-					rotate_ll(node);
+					rebalance(node);
 					break ;
 				}
-				if (bf < -1)
-				{
-					if (balance_factor(node->right) > 0)
-						rotate_ll(node->right);
-					rotate_rr(node);
+				if (node->height == old_height)
 					break ;
-				}
 				node = node->parent;
 			}
 		}
 
 		void	erase_rebalance(node_pointer node)
 		{
-			int bf;
+			int old_height;
 
 			while (node != _sentinel)
 			{
-				bf = balance_factor(node);
-				if (bf > 1)
-				{
-					if (balance_factor(node->left) < 0)
-						rotate_rr(node->left);
-					rotate_ll(node);
-				}
-				if (bf < -1)
-				{
-					if (balance_factor(node->right) > 0)
-						rotate_ll(node->right);
-					rotate_rr(node);
-				}
+				old_height = node->height;
+				update_height(node);
+				node = rebalance(node);
+				if (node->height == old_height)
+					break ;
 				node = node->parent;
 			}
 		}
 
-		void	destroy(node_pointer node)
+		// mirrors the shape and cached heights of other without comparing
+		// anything, taking nodes from reuse before allocating new ones. A copy
+		// that throws frees the part already cloned and the rest of reuse,
+		// the tree is then left empty
+		void	copy_from(const tree& other, node_pointer reuse)
+		{
+			node_pointer root = NULL;
+
+			try
+			{
+				if (other._root)
+					clone_subtree(other._root, root, _sentinel, reuse);
+			}
+			catch (...)
+			{
+				destroy_subtree(root);
+				destroy_list(reuse);
+				reset_extremes();
+				throw ;
+			}
+			set_root(root);
+			reset_extremes();
+			_size = other._size;
+			destroy_list(reuse);
+		}
+
+		// every node is linked under its parent before its children are
+		// cloned, so a throw leaves a partial tree destroy_subtree can free
+		void	clone_subtree(node_pointer src, node_pointer& link, node_pointer parent, node_pointer& reuse)
+		{
+			node_pointer node = clone_node(src->value, reuse);
+
+			link = node;
+			node->parent = parent;
+			node->height = src->height;
+			node->metadata = src->metadata;
+			if (src->left)
+				clone_subtree(src->left, node->left, node, reuse);
+			if (src->right)
+				clone_subtree(src->right, node->right, node, reuse);
+		}
+
+		// a reused node whose new value throws goes back to the pool
+		node_pointer	clone_node(const value_type& val, node_pointer& reuse)
+		{
+			node_pointer node = reuse;
+
+			if (!node)
+				return create_node(val);
+			reuse = node->parent;
+			_alloc.destroy(node);
+			try
+			{
+				_alloc.construct(node, node_type(val));
+			}
+			catch (...)
+			{
+				_pool.deallocate(node);
+				throw ;
+			}
+			return node;
+		}
+
+		// holds a default value, whose copy may throw too
+		node_pointer	create_sentinel()
+		{
+			node_pointer sentinel = _alloc.allocate(1);
+
+			try
+			{
+				_alloc.construct(sentinel, node_type());
+			}
+			catch (...)
+			{
+				_alloc.deallocate(sentinel, 1);
+				throw ;
+			}
+			sentinel->is_sentinel = true;
+			return sentinel;
+		}
+
+		void	destroy_list(node_pointer list)
+		{
+			while (list)
+			{
+				node_pointer next = list->parent;
+				destroy_node(list);
+				list = next;
+			}
+		}
+
+		// threads a subtree into a list through the parent links
+		void	collect_nodes(node_pointer node, node_pointer& list)
+		{
+			if (!node)
+				return ;
+			collect_nodes(node->left, list);
+			collect_nodes(node->right, list);
+			node->parent = list;
+			list = node;
+		}
+
+		size_type	destroy_subtree(node_pointer node)
+		{
+			node_pointer	left;
+			node_pointer	right;
+
+			if (!node)
+				return 0;
+			left = node->left;
+			right = node->right;
+			destroy_node(node);
+			return destroy_subtree(left) + destroy_subtree(right) + 1;
+		}
+
+		void	destroy_node(node_pointer node)
+		{
+			_alloc.destroy(node);
+			_pool.deallocate(node);
+		}
+
+		// a pool owning its arena hands the slabs back in one go in clear(),
+		// then only the values need to be destroyed here
+		void	destroy(node_pointer node, bool deallocate)
 		{
 			if (!node)
 				return ;
-			destroy(node->left);
-			destroy(node->right);
+			destroy(node->left, deallocate);
+			destroy(node->right, deallocate);
 			_alloc.destroy(node);
-			_alloc.deallocate(node, 1);
+			if (deallocate)
+				_pool.deallocate(node);
 		}
 	};
 }
@@ -0,0 +1,1051 @@
+#ifndef BTREE_HPP
+# define BTREE_HPP
+
+# include <memory>
+# include <limits>
+# include <algorithm>
+# include <cstring>
+# include "utils.hpp"
+# include "iterator.hpp"
+
+namespace ft
+{
+	/* btree nodes */
+	// raw room for N objects of T, constructed one by one as a node fills
+	template <typename T, std::size_t N>
+	union btree_storage
+	{
+		unsigned char	bytes[N * sizeof(T)];
+		long double		align_ld;
+		double			align_d;
+		void*			align_ptr;
+
+		T*			data() { return reinterpret_cast<T*>(bytes); }
+		const T*	data() const { return reinterpret_cast<const T*>(bytes); }
+	};
+
+	struct btree_node_base
+	{
+		bool		is_leaf;
+		std::size_t	count;
+	};
+
+	// a full leaf splits before it takes a value, so a copy that throws
+	// never finds it overfull
+	template <typename Value, std::size_t Slots>
+	struct btree_leaf : public btree_node_base
+	{
+		typedef Value	value_type;
+
+		btree_leaf*					prev;
+		btree_leaf*					next;
+		btree_storage<Value, Slots>	values;
+	};
+
+	// count keys and count + 1 children, every key of children[i] is less
+	// than keys[i] and every key of children[i + 1] is not. An internal node
+	// has one spare slot: a full one takes the new entry first and splits
+	// right after
+	template <typename Key, std::size_t Slots>
+	struct btree_internal : public btree_node_base
+	{
+		btree_storage<Key, Slots + 1>	keys;
+		btree_node_base*				children[Slots + 2];
+	};
+
+
+	/* b+tree */
+	// values are only kept in the leaves, which are linked in order for
+	// iteration; internal nodes hold copies of keys to route the descent.
+	// A node is sized to about NodeBytes so a level costs a few cache lines
+	// instead of one miss per comparison. Unlike ft::tree, insert and erase
+	// invalidate iterators, since values move around inside the nodes
+	template <typename Key, typename T, typename KeyOfValue, typename Compare, typename Alloc,
+		std::size_t NodeBytes = 256>
+	class btree
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										value_type;
+		typedef KeyOfValue								key_of_value;
+		typedef Compare									key_compare;
+		typedef Alloc									allocator_type;
+		typedef std::size_t								size_type;
+		typedef std::ptrdiff_t							difference_type;
+
+		static const size_type	leaf_slots = NodeBytes / sizeof(value_type) < 4 ? 4 : NodeBytes / sizeof(value_type);
+		static const size_type	internal_slots = NodeBytes / (sizeof(key_type) + sizeof(void*)) < 4
+									? 4 : NodeBytes / (sizeof(key_type) + sizeof(void*));
+		static const size_type	min_leaf = leaf_slots / 2;
+		static const size_type	min_internal = internal_slots / 2;
+		static const int		max_depth = 64;
+
+		typedef btree_leaf<value_type, leaf_slots>				leaf_type;
+		typedef btree_internal<key_type, internal_slots>		internal_type;
+		typedef btree_node_base*								node_pointer;
+		typedef leaf_type*										leaf_pointer;
+		typedef internal_type*									internal_pointer;
+		typedef ft::btree_iterator<value_type, leaf_type>		iterator;
+		typedef ft::btree_iterator<const value_type, leaf_type>	const_iterator;
+
+	private:
+		typedef typename Alloc::template rebind<key_type>::other		key_allocator_type;
+		typedef typename Alloc::template rebind<leaf_type>::other		leaf_allocator_type;
+		typedef typename Alloc::template rebind<internal_type>::other	internal_allocator_type;
+
+		key_compare				_comp;
+		allocator_type			_alloc;
+		key_allocator_type		_key_alloc;
+		leaf_allocator_type		_leaf_alloc;
+		internal_allocator_type	_internal_alloc;
+		node_pointer			_root;
+		leaf_pointer			_first;
+		leaf_pointer			_last;
+		size_type				_size;
+
+	public:
+		/* constructor */
+		btree(const key_compare& comp, const allocator_type& alloc)
+		: _comp(comp), _alloc(alloc), _key_alloc(alloc), _leaf_alloc(alloc), _internal_alloc(alloc),
+		  _root(NULL), _first(NULL), _last(NULL), _size(0) {}
+
+		btree(const btree& other)
+		: _comp(other._comp), _alloc(other._alloc), _key_alloc(other._alloc), _leaf_alloc(other._alloc),
+		  _internal_alloc(other._alloc), _root(NULL), _first(NULL), _last(NULL), _size(0)
+		{ copy_from(other); }
+
+		/* destructor */
+		~btree() { clear(); }
+
+		/* assignment operator */
+		btree& operator=(const btree& other)
+		{
+			if (this != &other)
+			{
+				clear();
+				_comp = other._comp;
+				copy_from(other);
+			}
+			return *this;
+		}
+
+		/* iterators */
+		iterator		begin() { return iterator(_first, 0); }
+		const_iterator	begin() const { return const_iterator(_first, 0); }
+		iterator		end() { return iterator(_last, _last ? _last->count : 0); }
+		const_iterator	end() const { return const_iterator(_last, _last ? _last->count : 0); }
+
+		/* capacity */
+		bool		empty() const { return _size == 0; }
+		size_type	size() const { return _size; }
+		size_type	max_size() const
+		{ return std::min<size_type>(_alloc.max_size(), std::numeric_limits<difference_type>::max()); }
+
+		/* modifiers */
+		ft::pair<iterator, bool> insert(const value_type& val)
+		{ return try_emplace(key_of_value()(val), value_copier(val)); }
+
+		// make() is only called once the key is known to be missing
+		template <typename Maker>
+		ft::pair<iterator, bool> try_emplace(const key_type& k, const Maker& make)
+		{
+			internal_pointer	path[max_depth];
+			size_type			index[max_depth];
+			int					depth;
+			leaf_pointer		leaf;
+			size_type			pos;
+
+			if (!_root)
+			{
+				leaf = new_leaf();
+				_root = leaf;
+				_first = leaf;
+				_last = leaf;
+			}
+			leaf = descend(k, path, index, depth);
+			pos = leaf_lower_bound(leaf, k);
+			if (pos != leaf->count && !_comp(k, key(leaf, pos)))
+				return ft::make_pair(iterator(leaf, pos), false);
+			if (leaf->count == leaf_slots)
+			{
+				split_leaf(leaf, path, index, depth);
+				leaf = descend(k, path, index, depth);
+				pos = leaf_lower_bound(leaf, k);
+			}
+
+			const value_type& val = make();
+
+			leaf = insert_values(leaf, depth ? path[depth - 1] : NULL, pos, &val, 1);
+			++_size;
+			return ft::make_pair(iterator(leaf, pos), true);
+		}
+
+		// a hint whose leaf has room and holds val between its values, or
+		// at the open end of the first or last leaf, takes val without a
+		// descent. Anything else, a full leaf included, goes the usual way
+		iterator insert(iterator position, const value_type& val)
+		{
+			const key_type&	k = key_of_value()(val);
+			leaf_pointer	leaf = position.leaf();
+			size_type		pos;
+
+			if (!leaf || leaf->count == 0 || leaf->count >= leaf_slots
+				|| (leaf != _first && _comp(k, key(leaf, 0)))
+				|| (leaf != _last && _comp(key(leaf, leaf->count - 1), k)))
+				return insert(val).first;
+			pos = leaf_lower_bound(leaf, k);
+			if (pos != leaf->count && !_comp(k, key(leaf, pos)))
+				return iterator(leaf, pos);
+			// without a path the leaf cannot be rebuilt under its parent
+			if (!nothrow_shift && pos != leaf->count)
+				return insert(val).first;
+			insert_values(leaf, NULL, pos, &val, 1);
+			++_size;
+			return iterator(leaf, pos);
+		}
+
+		template <typename InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		template <typename K>
+		size_type erase(const K& k)
+		{
+			internal_pointer	path[max_depth];
+			size_type			index[max_depth];
+			int					depth;
+			leaf_pointer		leaf;
+			size_type			pos;
+
+			if (!_root)
+				return 0;
+			leaf = descend(k, path, index, depth);
+			pos = leaf_lower_bound(leaf, k);
+			if (pos == leaf->count || _comp(k, key(leaf, pos)))
+				return 0;
+			leaf = erase_values(leaf, depth ? path[depth - 1] : NULL, pos, pos + 1);
+			--_size;
+			rebalance(leaf, path, index, depth);
+			return 1;
+		}
+
+		void erase(iterator position) { erase(key_of_value()(*position)); }
+
+		// the range goes leaf by leaf along the leaf links: every value of
+		// a leaf in [lo, hi) is dropped at once, then the leaf and its path
+		// are fixed in one pass. A fix reshapes the leaves, so the next leaf
+		// is found again from lo: one descent per leaf, not per value
+		void erase(iterator first, iterator last)
+		{
+			internal_pointer	path[max_depth];
+			size_type			index[max_depth];
+			int					depth;
+			leaf_pointer		leaf;
+			size_type			pos;
+			size_type			stop;
+			bool				done;
+
+			if (first == last)
+				return ;
+			if (first == begin() && last == end())
+				return clear();
+
+			bool		to_end = last == end();
+			key_type	lo(key_of_value()(*first));
+			// not looked at when the range runs to the end
+			key_type	hi(key_of_value()(to_end ? *first : *last));
+
+			do
+			{
+				leaf = descend(lo, path, index, depth);
+				pos = leaf_lower_bound(leaf, lo);
+				if (pos == leaf->count)
+				{
+					if (!leaf->next)
+						return ;
+					leaf = descend(key(leaf->next, 0), path, index, depth);
+					pos = 0;
+				}
+				stop = to_end ? leaf->count : leaf_lower_bound(leaf, hi);
+				if (stop <= pos)
+					return ;
+				done = stop < leaf->count || !leaf->next;
+				leaf = erase_values(leaf, depth ? path[depth - 1] : NULL, pos, stop);
+				_size -= stop - pos;
+				rebalance(leaf, path, index, depth);
+			}
+			while (!done && _root);
+		}
+
+		void swap(btree& x)
+		{
+			std::swap(_comp, x._comp);
+			std::swap(_alloc, x._alloc);
+			std::swap(_key_alloc, x._key_alloc);
+			std::swap(_leaf_alloc, x._leaf_alloc);
+			std::swap(_internal_alloc, x._internal_alloc);
+			std::swap(_root, x._root);
+			std::swap(_first, x._first);
+			std::swap(_last, x._last);
+			std::swap(_size, x._size);
+		}
+
+		void clear()
+		{
+			if (_root)
+				destroy(_root);
+			_root = NULL;
+			_first = NULL;
+			_last = NULL;
+			_size = 0;
+		}
+
+		/* operations */
+		template <typename K>
+		iterator		find(const K& k) { return make_iterator(find_leaf(k)); }
+		template <typename K>
+		const_iterator	find(const K& k) const { return make_iterator(find_leaf(k)); }
+
+		template <typename K>
+		size_type		count(const K& k) const { return find(k) == end() ? 0 : 1; }
+
+		template <typename K>
+		iterator		lower_bound(const K& k) { return make_iterator(bound(k, false)); }
+		template <typename K>
+		const_iterator	lower_bound(const K& k) const { return make_iterator(bound(k, false)); }
+
+		template <typename K>
+		iterator		upper_bound(const K& k) { return make_iterator(bound(k, true)); }
+		template <typename K>
+		const_iterator	upper_bound(const K& k) const { return make_iterator(bound(k, true)); }
+
+		template <typename K>
+		ft::pair<iterator, iterator> equal_range(const K& k)
+		{ return ft::make_pair(lower_bound(k), upper_bound(k)); }
+		template <typename K>
+		ft::pair<const_iterator, const_iterator> equal_range(const K& k) const
+		{ return ft::make_pair(lower_bound(k), upper_bound(k)); }
+
+		/* observers */
+		key_compare	key_comp() const { return _comp; }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		typedef ft::pair<leaf_pointer, size_type>	position;
+
+		struct value_copier
+		{
+			const value_type&	val;
+
+			explicit value_copier(const value_type& v) : val(v) {}
+			const value_type& operator()() const { return val; }
+		};
+
+		/* private member function */
+		static iterator	make_iterator(const position& p) { return iterator(p.first, p.second); }
+
+		static const key_type&	key(const leaf_type* leaf, size_type pos)
+		{ return key_of_value()(leaf->values.data()[pos]); }
+
+		// the in-node searches halve the range without branching on the
+		// comparison, which a random key would mispredict half of the time
+
+		// first value not less than k
+		template <typename K>
+		size_type	leaf_lower_bound(const leaf_type* leaf, const K& k) const
+		{
+			const value_type*	base = leaf->values.data();
+			size_type			n = leaf->count;
+			size_type			half;
+
+			if (n == 0)
+				return 0;
+			while (n > 1)
+			{
+				half = n / 2;
+				base = _comp(key_of_value()(base[half]), k) ? base + half : base;
+				n -= half;
+			}
+			return base - leaf->values.data() + _comp(key_of_value()(*base), k);
+		}
+
+		// first value greater than k
+		template <typename K>
+		size_type	leaf_upper_bound(const leaf_type* leaf, const K& k) const
+		{
+			const value_type*	base = leaf->values.data();
+			size_type			n = leaf->count;
+			size_type			half;
+
+			if (n == 0)
+				return 0;
+			while (n > 1)
+			{
+				half = n / 2;
+				base = _comp(k, key_of_value()(base[half])) ? base : base + half;
+				n -= half;
+			}
+			return base - leaf->values.data() + !_comp(k, key_of_value()(*base));
+		}
+
+		// the child whose range holds k: the first key greater than k
+		template <typename K>
+		size_type	child_index(const internal_type* node, const K& k) const
+		{
+			const key_type*	base = node->keys.data();
+			size_type		n = node->count;
+			size_type		half;
+
+			while (n > 1)
+			{
+				half = n / 2;
+				base = _comp(k, base[half]) ? base : base + half;
+				n -= half;
+			}
+			return base - node->keys.data() + !_comp(k, *base);
+		}
+
+		// records the internal nodes on the way down and the child taken in
+		// each, insert and erase fix the tree back up along that path
+		template <typename K>
+		leaf_pointer	descend(const K& k, internal_pointer* path, size_type* index, int& depth) const
+		{
+			node_pointer	node = _root;
+			size_type		i;
+
+			depth = 0;
+			while (!node->is_leaf)
+			{
+				internal_pointer in = static_cast<internal_pointer>(node);
+
+				i = child_index(in, k);
+				path[depth] = in;
+				index[depth] = i;
+				++depth;
+				node = in->children[i];
+			}
+			return static_cast<leaf_pointer>(node);
+		}
+
+		template <typename K>
+		leaf_pointer	descend(const K& k) const
+		{
+			node_pointer node = _root;
+
+			while (!node->is_leaf)
+			{
+				internal_pointer in = static_cast<internal_pointer>(node);
+
+				prefetch(in->keys.data(), in->count * sizeof(key_type));
+				node = in->children[child_index(in, k)];
+			}
+			prefetch(static_cast<leaf_pointer>(node)->values.data(), node->count * sizeof(value_type));
+			return static_cast<leaf_pointer>(node);
+		}
+
+		// asks for every line of a node at once, the binary search then
+		// waits for one miss instead of one per probe
+		static void	prefetch(const void* p, size_type bytes)
+		{
+#if defined(__GNUC__)
+			for (size_type i = 0; i < bytes; i += 64)
+				__builtin_prefetch(static_cast<const char*>(p) + i);
+#else
+			(void)p;
+			(void)bytes;
+#endif
+		}
+
+		// a position past the last value of a leaf is the front of the next
+		// one, or end() on the last leaf
+		position	normalize(leaf_pointer leaf, size_type pos) const
+		{
+			if (pos == leaf->count && leaf->next)
+				return position(leaf->next, 0);
+			return position(leaf, pos);
+		}
+
+		template <typename K>
+		position	find_leaf(const K& k) const
+		{
+			leaf_pointer	leaf;
+			size_type		pos;
+
+			if (!_root)
+				return position(NULL, 0);
+			leaf = descend(k);
+			pos = leaf_lower_bound(leaf, k);
+			if (pos == leaf->count || _comp(k, key(leaf, pos)))
+				return position(_last, _last->count);
+			return position(leaf, pos);
+		}
+
+		template <typename K>
+		position	bound(const K& k, bool upper) const
+		{
+			leaf_pointer leaf;
+
+			if (!_root)
+				return position(NULL, 0);
+			leaf = descend(k);
+			return normalize(leaf, upper ? leaf_upper_bound(leaf, k) : leaf_lower_bound(leaf, k));
+		}
+
+		/* nodes */
+		leaf_pointer	new_leaf()
+		{
+			leaf_pointer leaf = _leaf_alloc.allocate(1);
+
+			leaf->is_leaf = true;
+			leaf->count = 0;
+			leaf->prev = NULL;
+			leaf->next = NULL;
+			return leaf;
+		}
+
+		internal_pointer	new_internal()
+		{
+			internal_pointer node = _internal_alloc.allocate(1);
+
+			node->is_leaf = false;
+			node->count = 0;
+			return node;
+		}
+
+		void	delete_leaf(leaf_pointer leaf) { _leaf_alloc.deallocate(leaf, 1); }
+		void	delete_internal(internal_pointer node) { _internal_alloc.deallocate(node, 1); }
+
+		void	destroy(node_pointer node)
+		{
+			size_type i;
+
+			if (node->is_leaf)
+			{
+				leaf_pointer leaf = static_cast<leaf_pointer>(node);
+
+				for (i = 0; i < leaf->count; ++i)
+					_alloc.destroy(leaf->values.data() + i);
+				delete_leaf(leaf);
+				return ;
+			}
+			internal_pointer in = static_cast<internal_pointer>(node);
+
+			for (i = 0; i <= in->count; ++i)
+				destroy(in->children[i]);
+			for (i = 0; i < in->count; ++i)
+				_key_alloc.destroy(in->keys.data() + i);
+			delete_internal(in);
+		}
+
+		/* slots */
+		// objects in a node are never assigned, pair<const Key, T> cannot be:
+		// they are built in a raw slot and the old one is destroyed. A shift
+		// inside a leaf must not fail half way, it would leave a hole: values
+		// that are byte copies go with memmove and, in C++11, values whose
+		// move cannot throw are moved. Any other leaf is copied whole into a
+		// new node, which takes the place of the old one once it is complete
+		static const bool	trivial_values = ft::is_trivially_copy_constructible<value_type>::value
+								&& ft::is_trivially_destructible<value_type>::value;
+#if __cplusplus >= 201103L
+		static const bool	nothrow_shift = trivial_values || std::is_nothrow_move_constructible<value_type>::value;
+#else
+		static const bool	nothrow_shift = trivial_values;
+#endif
+
+		void	move_value(value_type* dst, value_type* src)
+		{
+#if __cplusplus >= 201103L
+			_alloc.construct(dst, std::move(*src));
+#else
+			_alloc.construct(dst, *src);
+#endif
+			_alloc.destroy(src);
+		}
+
+		// the ranges may overlap, only called when nothrow_shift holds or
+		// with nothing to move
+		void	shift_values(value_type* dst, value_type* src, size_type n)
+		{
+			if (trivial_values)
+				std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+			else if (dst < src)
+				for (size_type i = 0; i < n; ++i)
+					move_value(dst + i, src + i);
+			else
+				for (size_type i = n; i > 0; --i)
+					move_value(dst + i - 1, src + i - 1);
+		}
+
+		// into raw slots, none is left behind when a copy throws
+		void	copy_values(value_type* dst, const value_type* src, size_type n)
+		{
+			size_type i = 0;
+
+			try
+			{
+				for (; i < n; ++i)
+					_alloc.construct(dst + i, src[i]);
+			}
+			catch (...)
+			{
+				destroy_values(dst, i);
+				throw ;
+			}
+		}
+
+		void	destroy_values(value_type* p, size_type n)
+		{
+			for (size_type i = 0; i < n; ++i)
+				_alloc.destroy(p + i);
+		}
+
+		// from one node into the raw slots of another, the source is only
+		// dropped once every copy is made
+		void	relocate_values(value_type* dst, value_type* src, size_type n)
+		{
+			if (nothrow_shift)
+				return shift_values(dst, src, n);
+			copy_values(dst, src, n);
+			destroy_values(src, n);
+		}
+
+		void	move_key(key_type* dst, key_type* src)
+		{
+			_key_alloc.construct(dst, *src);
+			_key_alloc.destroy(src);
+		}
+
+		void	set_key(internal_pointer node, size_type i, const key_type& k)
+		{
+			_key_alloc.destroy(node->keys.data() + i);
+			_key_alloc.construct(node->keys.data() + i, k);
+		}
+
+		// copies of the n values at src, outside this leaf, go in at pos.
+		// The leaf returned holds them: a new one under parent when the
+		// values after pos could not shift in place
+		leaf_pointer	insert_values(leaf_pointer leaf, internal_pointer parent, size_type pos,
+							const value_type* src, size_type n)
+		{
+			value_type*	values = leaf->values.data();
+			size_type	tail = leaf->count - pos;
+
+			if (!nothrow_shift && tail)
+				return rebuild_leaf(leaf, parent, pos, pos, src, n);
+			shift_values(values + pos + n, values + pos, tail);
+			try
+			{
+				copy_values(values + pos, src, n);
+			}
+			catch (...)
+			{
+				shift_values(values + pos, values + pos + n, tail);
+				throw ;
+			}
+			leaf->count += n;
+			return leaf;
+		}
+
+		// drops the values in [pos, stop), the rest moves down once
+		leaf_pointer	erase_values(leaf_pointer leaf, internal_pointer parent, size_type pos, size_type stop)
+		{
+			value_type*	values = leaf->values.data();
+			size_type	tail = leaf->count - stop;
+
+			if (!nothrow_shift && tail)
+				return rebuild_leaf(leaf, parent, pos, stop, NULL, 0);
+			destroy_values(values + pos, stop - pos);
+			shift_values(values + pos, values + stop, tail);
+			leaf->count -= stop - pos;
+			return leaf;
+		}
+
+		// a new node with the values of leaf, [pos, stop) replaced by the n
+		// values at src. Nothing changes until it is complete, then it takes
+		// the place of leaf under parent and in the leaf links
+		leaf_pointer	rebuild_leaf(leaf_pointer leaf, internal_pointer parent, size_type pos, size_type stop,
+							const value_type* src, size_type n)
+		{
+			leaf_pointer		fresh = new_leaf();
+			value_type*			values = leaf->values.data();
+			const value_type*	from[3] = { values, src, values + stop };
+			size_type			len[3] = { pos, n, leaf->count - stop };
+			size_type			i;
+
+			try
+			{
+				for (int part = 0; part < 3; ++part)
+					for (i = 0; i < len[part]; ++i, ++fresh->count)
+						_alloc.construct(fresh->values.data() + fresh->count, from[part][i]);
+			}
+			catch (...)
+			{
+				destroy(fresh);
+				throw ;
+			}
+			destroy_values(values, leaf->count);
+			fresh->prev = leaf->prev;
+			fresh->next = leaf->next;
+			if (leaf->prev)
+				leaf->prev->next = fresh;
+			else
+				_first = fresh;
+			if (leaf->next)
+				leaf->next->prev = fresh;
+			else
+				_last = fresh;
+			if (!parent)
+				_root = fresh;
+			else
+				for (i = 0; i <= parent->count; ++i)
+					if (parent->children[i] == leaf)
+						parent->children[i] = fresh;
+			delete_leaf(leaf);
+			return fresh;
+		}
+
+		// key i and child i + 1 go in, or out
+		void	insert_entry(internal_pointer node, size_type i, const key_type& k, node_pointer child)
+		{
+			key_type* keys = node->keys.data();
+
+			for (size_type j = node->count; j > i; --j)
+			{
+				move_key(keys + j, keys + j - 1);
+				node->children[j + 1] = node->children[j];
+			}
+			_key_alloc.construct(keys + i, k);
+			node->children[i + 1] = child;
+			++node->count;
+		}
+
+		void	erase_entry(internal_pointer node, size_type i)
+		{
+			key_type* keys = node->keys.data();
+
+			_key_alloc.destroy(keys + i);
+			for (size_type j = i; j + 1 < node->count; ++j)
+			{
+				move_key(keys + j, keys + j + 1);
+				node->children[j + 1] = node->children[j + 2];
+			}
+			--node->count;
+		}
+
+		/* insert */
+		// the upper half of a full leaf moves to a new right sibling whose
+		// first key goes up as the separator
+		void	split_leaf(leaf_pointer leaf, internal_pointer* path, size_type* index, int depth)
+		{
+			leaf_pointer	right = new_leaf();
+			size_type		half = leaf->count / 2;
+
+			try
+			{
+				relocate_values(right->values.data(), leaf->values.data() + half, leaf->count - half);
+			}
+			catch (...)
+			{
+				delete_leaf(right);
+				throw ;
+			}
+			right->count = leaf->count - half;
+			leaf->count = half;
+			right->prev = leaf;
+			right->next = leaf->next;
+			if (leaf->next)
+				leaf->next->prev = right;
+			else
+				_last = right;
+			leaf->next = right;
+			insert_child(path, index, depth, key(right, 0), right);
+		}
+
+		// hangs right next to the node path[depth - 1] led to, splitting the
+		// parents that overflow on the way up
+		void	insert_child(internal_pointer* path, size_type* index, int depth, const key_type& k, node_pointer right)
+		{
+			internal_pointer	node;
+			internal_pointer	sibling;
+			size_type			mid;
+
+			if (depth == 0)
+			{
+				node = new_internal();
+				_key_alloc.construct(node->keys.data(), k);
+				node->children[0] = _root;
+				node->children[1] = right;
+				node->count = 1;
+				_root = node;
+				return ;
+			}
+			node = path[depth - 1];
+			insert_entry(node, index[depth - 1], k, right);
+			if (node->count <= internal_slots)
+				return ;
+			sibling = new_internal();
+			mid = node->count / 2;
+			for (size_type i = mid + 1; i < node->count; ++i)
+			{
+				move_key(sibling->keys.data() + i - mid - 1, node->keys.data() + i);
+				sibling->children[i - mid - 1] = node->children[i];
+			}
+			sibling->children[node->count - mid - 1] = node->children[node->count];
+			sibling->count = node->count - mid - 1;
+			node->count = mid;
+
+			key_type up(node->keys.data()[mid]);
+
+			_key_alloc.destroy(node->keys.data() + mid);
+			insert_child(path, index, depth - 1, up, sibling);
+		}
+
+		/* erase */
+		// after values left the leaf, fixes it and then the parents on the
+		// path that lost an entry. The root goes once it has a single child
+		void	rebalance(leaf_pointer leaf, internal_pointer* path, size_type* index, int depth)
+		{
+			int d;
+
+			if (depth == 0)
+			{
+				if (leaf->count == 0)
+				{
+					delete_leaf(leaf);
+					_root = NULL;
+					_first = NULL;
+					_last = NULL;
+				}
+				return ;
+			}
+			if (leaf->count >= min_leaf)
+				return ;
+			fix_leaf(leaf, path[depth - 1], index[depth - 1]);
+			for (d = depth - 1; d > 0 && path[d]->count < min_internal; --d)
+				fix_internal(path[d], path[d - 1], index[d - 1]);
+			if (!_root->is_leaf && _root->count == 0)
+			{
+				internal_pointer old = static_cast<internal_pointer>(_root);
+
+				_root = old->children[0];
+				delete_internal(old);
+			}
+		}
+
+		// an underfull leaf borrows what it misses from a sibling that can
+		// spare it, or merges with one: both then hold less than two minimums
+		// together. One emptied by a range erase just leaves the tree
+		void	fix_leaf(leaf_pointer leaf, internal_pointer parent, size_type i)
+		{
+			leaf_pointer	left = i > 0 ? static_cast<leaf_pointer>(parent->children[i - 1]) : NULL;
+			leaf_pointer	right = i < parent->count ? static_cast<leaf_pointer>(parent->children[i + 1]) : NULL;
+			size_type		need = min_leaf - leaf->count;
+
+			if (leaf->count == 0)
+			{
+				unlink_leaf(leaf);
+				if (i == 0)
+					parent->children[0] = parent->children[1];
+				erase_entry(parent, i > 0 ? i - 1 : 0);
+			}
+			else if (left && left->count >= min_leaf + need)
+			{
+				value_type* moved = left->values.data() + left->count - need;
+
+				leaf = insert_values(leaf, parent, 0, moved, need);
+				destroy_values(moved, need);
+				left->count -= need;
+				set_key(parent, i - 1, key(leaf, 0));
+			}
+			else if (right && right->count >= min_leaf + need)
+			{
+				insert_values(leaf, parent, leaf->count, right->values.data(), need);
+				try
+				{
+					right = erase_values(right, parent, 0, need);
+				}
+				catch (...)
+				{
+					leaf->count -= need;
+					destroy_values(leaf->values.data() + leaf->count, need);
+					throw ;
+				}
+				set_key(parent, i, key(right, 0));
+			}
+			else if (left)
+			{
+				merge_leaves(left, leaf);
+				erase_entry(parent, i - 1);
+			}
+			else
+			{
+				merge_leaves(leaf, right);
+				erase_entry(parent, i);
+			}
+		}
+
+		void	merge_leaves(leaf_pointer leaf, leaf_pointer right)
+		{
+			relocate_values(leaf->values.data() + leaf->count, right->values.data(), right->count);
+			leaf->count += right->count;
+			right->count = 0;
+			unlink_leaf(right);
+		}
+
+		// takes an emptied leaf out of the leaf links and frees it
+		void	unlink_leaf(leaf_pointer leaf)
+		{
+			if (leaf->prev)
+				leaf->prev->next = leaf->next;
+			else
+				_first = leaf->next;
+			if (leaf->next)
+				leaf->next->prev = leaf->prev;
+			else
+				_last = leaf->prev;
+			delete_leaf(leaf);
+		}
+
+		// same for internal nodes, the separator rotates through the parent
+		void	fix_internal(internal_pointer node, internal_pointer parent, size_type i)
+		{
+			internal_pointer left = i > 0 ? static_cast<internal_pointer>(parent->children[i - 1]) : NULL;
+			internal_pointer right = i < parent->count ? static_cast<internal_pointer>(parent->children[i + 1]) : NULL;
+			key_type*		 keys = node->keys.data();
+
+			if (left && left->count > min_internal)
+			{
+				node->children[node->count + 1] = node->children[node->count];
+				for (size_type j = node->count; j > 0; --j)
+				{
+					move_key(keys + j, keys + j - 1);
+					node->children[j] = node->children[j - 1];
+				}
+				_key_alloc.construct(keys, parent->keys.data()[i - 1]);
+				node->children[0] = left->children[left->count];
+				++node->count;
+				set_key(parent, i - 1, left->keys.data()[left->count - 1]);
+				_key_alloc.destroy(left->keys.data() + left->count - 1);
+				--left->count;
+			}
+			else if (right && right->count > min_internal)
+			{
+				_key_alloc.construct(keys + node->count, parent->keys.data()[i]);
+				node->children[node->count + 1] = right->children[0];
+				++node->count;
+				set_key(parent, i, right->keys.data()[0]);
+				right->children[0] = right->children[1];
+				erase_entry(right, 0);
+			}
+			else if (left)
+			{
+				merge_internal(left, parent->keys.data()[i - 1], node);
+				erase_entry(parent, i - 1);
+			}
+			else
+			{
+				merge_internal(node, parent->keys.data()[i], right);
+				erase_entry(parent, i);
+			}
+		}
+
+		void	merge_internal(internal_pointer node, const key_type& separator, internal_pointer right)
+		{
+			key_type* keys = node->keys.data();
+
+			_key_alloc.construct(keys + node->count, separator);
+			for (size_type j = 0; j < right->count; ++j)
+				move_key(keys + node->count + 1 + j, right->keys.data() + j);
+			for (size_type j = 0; j <= right->count; ++j)
+				node->children[node->count + 1 + j] = right->children[j];
+			node->count += right->count + 1;
+			delete_internal(right);
+		}
+
+		/* copy */
+		// a copy that throws frees the part already cloned, the tree is
+		// then left empty
+		void	copy_from(const btree& other)
+		{
+			leaf_pointer prev = NULL;
+
+			if (!other._root)
+				return ;
+			try
+			{
+				_root = clone(other._root, prev);
+			}
+			catch (...)
+			{
+				_root = NULL;
+				_first = NULL;
+				_last = NULL;
+				_size = 0;
+				throw ;
+			}
+			_last = prev;
+			_size = other._size;
+		}
+
+		// mirrors the shape of src, relinking the leaves in order. Whatever
+		// this call built is freed again before an exception goes on
+		node_pointer	clone(const btree_node_base* src, leaf_pointer& prev)
+		{
+			size_type i;
+
+			if (src->is_leaf)
+			{
+				const leaf_type*	from = static_cast<const leaf_type*>(src);
+				leaf_pointer		leaf = new_leaf();
+
+				try
+				{
+					copy_values(leaf->values.data(), from->values.data(), from->count);
+				}
+				catch (...)
+				{
+					delete_leaf(leaf);
+					throw ;
+				}
+				leaf->count = from->count;
+				leaf->prev = prev;
+				if (prev)
+					prev->next = leaf;
+				else
+					_first = leaf;
+				prev = leaf;
+				return leaf;
+			}
+			const internal_type*	from = static_cast<const internal_type*>(src);
+			internal_pointer		node = new_internal();
+			size_type				keys = 0;
+
+			i = 0;
+			try
+			{
+				for (; keys < from->count; ++keys)
+					_key_alloc.construct(node->keys.data() + keys, from->keys.data()[keys]);
+				for (; i <= from->count; ++i)
+					node->children[i] = clone(from->children[i], prev);
+			}
+			catch (...)
+			{
+				while (i > 0)
+					destroy(node->children[--i]);
+				while (keys > 0)
+					_key_alloc.destroy(node->keys.data() + --keys);
+				delete_internal(node);
+				throw ;
+			}
+			node->count = from->count;
+			return node;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef BTREE_SET_HPP
+# define BTREE_SET_HPP
+
+# include "btree.hpp"
+
+namespace ft
+{
+	// sorted unique keys on a b+tree, insert and erase invalidate
+	// iterators, see btree.hpp
+	template <typename Key, typename Compare = ft::less<Key>, typename Alloc = std::allocator<Key> >
+	class btree_set
+	{
+	public:
+		typedef Key										key_type;
+		typedef Key										value_type;
+		typedef Compare									key_compare;
+		typedef Compare									value_compare;
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef typename ft::btree<key_type, value_type, ft::identity<value_type>,
+			key_compare, allocator_type>										tree_type;
+		// keys are never modified in place
+		typedef typename tree_type::const_iterator								iterator;
+		typedef typename tree_type::const_iterator								const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		key_compare		_key_comp;
+		tree_type		_tree;
+
+	public:
+		/* constructor */
+		explicit btree_set(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _tree(comp, alloc) {}
+
+		template <typename InputIterator>
+		btree_set(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _tree(comp, alloc)
+		{ insert(first, last); }
+
+		btree_set(const btree_set& other) : _key_comp(other._key_comp), _tree(other._tree) {}
+
+		/* destructor */
+		~btree_set() {}
+
+		/* assignment operator */
+		btree_set& operator=(const btree_set& s)
+		{
+			if (this != &s)
+				_tree = s._tree;
+			return *this;
+		}
+
+		/* iterators */
+		iterator			begin() const { return _tree.begin(); }
+		iterator			end() const { return _tree.end(); }
+		reverse_iterator	rbegin() const { return reverse_iterator(end()); }
+		reverse_iterator	rend() const { return reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _tree.empty(); }
+		size_type	size() const { return _tree.size(); }
+		size_type	max_size() const { return _tree.max_size(); }
+
+		/* modifiers */
+		ft::pair<iterator, bool> insert(const value_type& val)
+		{
+			ft::pair<typename tree_type::iterator, bool> p = _tree.insert(val);
+			return ft::make_pair(iterator(p.first), p.second);
+		}
+
+		iterator	insert(iterator position, const value_type& val) { return _tree.insert(mutable_iterator(position), val); }
+
+		template <typename InputIterator>
+		void		insert(InputIterator first, InputIterator last) { _tree.insert(first, last); }
+
+		void		erase(iterator position) { _tree.erase(*position); }
+		size_type	erase(const key_type& k) { return _tree.erase(k); }
+		void		erase(iterator first, iterator last) { _tree.erase(mutable_iterator(first), mutable_iterator(last)); }
+
+		void	swap(btree_set& x)
+		{
+			std::swap(_key_comp, x._key_comp);
+			_tree.swap(x._tree);
+		}
+
+		void	clear() { _tree.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _key_comp; }
+
+		/* operations */
+		iterator		find(const key_type& k) const { return _tree.find(k); }
+		size_type		count(const key_type& k) const { return _tree.count(k); }
+		iterator		lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
+		iterator		upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
+		ft::pair<iterator, iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _tree.get_allocator(); }
+
+	private:
+		static typename tree_type::iterator	mutable_iterator(iterator it)
+		{ return typename tree_type::iterator(it.leaf(), it.position()); }
+	};
+
+	/* relational operators */
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator==(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator!=(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator<(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator<=(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator>(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator>=(const btree_set<Key, Compare, Alloc>& lhs, const btree_set<Key, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename Compare, typename Alloc>
+	void swap(btree_set<Key, Compare, Alloc>& lhs, btree_set<Key, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef COMPACT_MAP_HPP
+# define COMPACT_MAP_HPP
+
+# include "compact_tree.hpp"
+
+namespace ft
+{
+	// ft::map on index-linked nodes packed in one vector: same interface,
+	// but references to values move when the node vector grows, see
+	// compact_tree.hpp
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class compact_map
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		class	value_compare
+		{
+			friend class compact_map;
+		protected:
+			key_compare comp;
+			value_compare (key_compare c) : comp(c) {}
+		public:
+			bool operator() (const value_type& x, const value_type& y) const
+			{ return (comp(x.first, y.first)); }
+		};
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef typename ft::compact_tree<key_type, value_type, ft::select_first<value_type>,
+			key_compare, allocator_type>										tree_type;
+		typedef typename tree_type::iterator									iterator;
+		typedef typename tree_type::const_iterator								const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		struct value_maker
+		{
+			const key_type&		key;
+			const mapped_type&	mapped;
+
+			value_maker(const key_type& k, const mapped_type& m) : key(k), mapped(m) {}
+			value_type operator()() const { return value_type(key, mapped); }
+		};
+
+		struct default_value_maker
+		{
+			const key_type&		key;
+
+			explicit default_value_maker(const key_type& k) : key(k) {}
+			value_type operator()() const { return value_type(key, mapped_type()); }
+		};
+
+		key_compare		_key_comp;
+		value_compare	_value_comp;
+		tree_type		_tree;
+
+	public:
+		/* constructor */
+		explicit compact_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _tree(comp, alloc) {}
+
+		template <typename InputIterator>
+		compact_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _tree(comp, alloc)
+		{ insert(first, last); }
+
+		compact_map(const compact_map& other)
+		: _key_comp(other._key_comp), _value_comp(other._value_comp), _tree(other._tree) {}
+
+		/* destructor */
+		~compact_map() {}
+
+		/* assignment operator */
+		compact_map& operator=(const compact_map& m)
+		{
+			if (this != &m)
+				_tree = m._tree;
+			return *this;
+		}
+
+		/* iterators */
+		iterator				begin() { return _tree.begin(); }
+		const_iterator			begin() const { return _tree.begin(); }
+		iterator				end() { return _tree.end(); }
+		const_iterator			end() const { return _tree.end(); }
+		reverse_iterator		rbegin() { return reverse_iterator(end()); }
+		const_reverse_iterator	rbegin() const { return const_reverse_iterator(end()); }
+		reverse_iterator		rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator	rend() const { return const_reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _tree.empty(); }
+		size_type	size() const { return _tree.size(); }
+		size_type	max_size() const { return _tree.max_size(); }
+		size_type	capacity() const { return _tree.capacity(); }
+		void		reserve(size_type n) { _tree.reserve(n); }
+
+		/* element access */
+		mapped_type& operator[] (const key_type& k) { return try_emplace(k).first->second; }
+
+		/* modifiers */
+		ft::pair<iterator, bool>	insert(const value_type& val) { return _tree.insert(val); }
+		iterator					insert(iterator position, const value_type& val) { return _tree.insert(position, val); }
+		template <typename InputIterator>
+		void						insert(InputIterator first, InputIterator last) { _tree.insert(first, last); }
+
+		ft::pair<iterator, bool>	try_emplace(const key_type& k) { return _tree.try_emplace(k, default_value_maker(k)); }
+		ft::pair<iterator, bool>	try_emplace(const key_type& k, const mapped_type& obj) { return _tree.try_emplace(k, value_maker(k, obj)); }
+
+		ft::pair<iterator, bool>	insert_or_assign(const key_type& k, const mapped_type& obj)
+		{
+			ft::pair<iterator, bool> p = try_emplace(k, obj);
+			if (!p.second)
+				p.first->second = obj;
+			return p;
+		}
+
+		void		erase(iterator position) { _tree.erase(position); }
+		size_type	erase(const key_type& k) { return _tree.erase(find(k)); }
+		void		erase(iterator first, iterator last) { _tree.erase(first, last); }
+
+		void	swap(compact_map& x)
+		{
+			std::swap(_key_comp, x._key_comp);
+			std::swap(_value_comp, x._value_comp);
+			_tree.swap(x._tree);
+		}
+
+		void	clear() { _tree.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _value_comp; }
+
+		/* operations */
+		iterator		find(const key_type& k) { return _tree.find(k); }
+		const_iterator	find(const key_type& k) const { return _tree.find(k); }
+
+		size_type		count(const key_type& k) const { return _tree.count(k); }
+
+		iterator		lower_bound(const key_type& k) { return _tree.lower_bound(k); }
+		const_iterator	lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
+
+		iterator		upper_bound(const key_type& k) { return _tree.upper_bound(k); }
+		const_iterator	upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
+
+		ft::pair<iterator, iterator> equal_range(const key_type& k) { return _tree.equal_range(k); }
+		ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _tree.get_allocator(); }
+	};
+
+	/* relational operators */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator==(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator!=(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<=(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>=(const compact_map<Key, T, Compare, Alloc>& lhs, const compact_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	void swap(compact_map<Key, T, Compare, Alloc>& lhs, compact_map<Key, T, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
@@ -0,0 +1,726 @@
+#ifndef COMPACT_TREE_HPP
+# define COMPACT_TREE_HPP
+
+# include <new>
+# include <memory>
+# include <limits>
+# include <stdexcept>
+# include "vector.hpp"
+
+namespace ft
+{
+	/* compact node */
+	// three 32-bit links instead of three pointers, a height and a flag:
+	// the parent link gives its top three bits to the balance factor (two
+	// bits) and to a flag telling that the slot holds no value, which is
+	// set on free slots and on the header. Children use 0 for none, the
+	// parent of the root is the header, which is 0 as well
+	template <typename T>
+	struct compact_node
+	{
+		typedef T				value_type;
+		typedef unsigned int	index_type;
+
+		static const index_type	index_mask = (1u << 29) - 1;
+		static const index_type	free_flag = 1u << 29;
+		static const int		balance_shift = 30;
+
+		ft::aligned_storage<T>	storage;
+		index_type				left;
+		index_type				right;
+		index_type				link;
+
+		compact_node() : left(0), right(0), link(free_flag | (1u << balance_shift)) {}
+
+		compact_node(const compact_node& other) : left(other.left), right(other.right), link(other.link)
+		{
+			if (!is_free())
+				new (storage.bytes) value_type(other.value());
+		}
+
+		~compact_node()
+		{
+			if (!is_free())
+				value().~value_type();
+		}
+
+		value_type&			value() { return *storage.data(); }
+		const value_type&	value() const { return *storage.data(); }
+
+		index_type	parent() const { return link & index_mask; }
+		void		set_parent(index_type p) { link = (link & ~index_mask) | p; }
+
+		// height of the right subtree minus the left one
+		int			balance() const { return static_cast<int>(link >> balance_shift) - 1; }
+		void		set_balance(int b) { link = (link & ((1u << balance_shift) - 1)) | (static_cast<index_type>(b + 1) << balance_shift); }
+
+		bool		is_free() const { return link & free_flag; }
+		void		set_free(bool f) { link = f ? (link | free_flag) : (link & ~free_flag); }
+
+	private:
+		compact_node& operator=(const compact_node&);
+	};
+
+
+	/* compact avl tree */
+	// the same avl tree as ft::tree, with its nodes in one ft::vector and
+	// linked by index. A node for ft::map<int, int> takes 20 bytes instead
+	// of 40, and lookups walk one contiguous block. Erased slots go to a
+	// freelist threaded through their left link. Iterators hold an index,
+	// so they survive inserts, but references to values move when the
+	// vector grows, and iterators follow the object, not the nodes, on swap
+	template <typename Key, typename T, typename KeyOfValue, typename Compare, typename Alloc>
+	class compact_tree
+	{
+	public:
+		typedef Key															key_type;
+		typedef T															value_type;
+		typedef KeyOfValue													key_of_value;
+		typedef Compare														key_compare;
+		typedef compact_node<value_type>									node_type;
+		typedef typename node_type::index_type								index_type;
+		typedef typename Alloc::template rebind<node_type>::other			allocator_type;
+		typedef ft::vector<node_type, allocator_type>						node_vector;
+		typedef ft::compact_tree_iterator<value_type, node_vector>			iterator;
+		typedef ft::compact_tree_iterator<const value_type, node_vector>	const_iterator;
+		typedef std::size_t													size_type;
+		typedef std::ptrdiff_t												difference_type;
+
+	private:
+		typedef typename Alloc::template rebind<value_type>::other			value_allocator_type;
+
+		key_compare				_comp;
+		value_allocator_type	_value_alloc;
+		node_vector				_nodes;		// [0] is the header
+		index_type				_free;
+		size_type				_size;
+
+	public:
+		/* constructor */
+		compact_tree(const key_compare& comp, const allocator_type& alloc)
+		: _comp(comp), _value_alloc(alloc), _nodes(alloc), _free(0), _size(0)
+		{ _nodes.push_back(node_type()); }
+
+		compact_tree(const compact_tree& other)
+		: _comp(other._comp), _value_alloc(other._value_alloc), _nodes(other._nodes), _free(other._free), _size(other._size) {}
+
+		/* destructor */
+		~compact_tree() {}
+
+		/* assignment operator */
+		// slots and links are copied as they are, there is nothing to relink
+		compact_tree& operator=(const compact_tree& t)
+		{
+			if (this != &t)
+			{
+				_nodes = t._nodes;
+				_free = t._free;
+				_size = t._size;
+			}
+			return *this;
+		}
+
+		/* iterators */
+		iterator		begin() { return iterator(&_nodes, leftmost()); }
+		const_iterator	begin() const { return const_iterator(nodes(), leftmost()); }
+
+		iterator		end() { return iterator(&_nodes, 0); }
+		const_iterator	end() const { return const_iterator(nodes(), 0); }
+
+		/* capacity */
+		bool		empty() const { return _size == 0; }
+		size_type	size() const { return _size; }
+
+		size_type	max_size() const { return std::min<size_type>(_nodes.max_size(), node_type::index_mask) - 1; }
+
+		// slots in use or on the freelist, and room before the vector grows
+		size_type	capacity() const { return _nodes.capacity() - 1; }
+		void		reserve(size_type n) { _nodes.reserve(n + 1); }
+
+		/* modifiers */
+		ft::pair<iterator, bool> insert(const value_type& val)
+		{
+			index_type	parent;
+			bool		is_left;
+			index_type	node = find_unique_position(key_of_value()(val), parent, is_left);
+
+			if (node)
+				return ft::make_pair(iterator(&_nodes, node), false);
+			node = link_node(create_node(val), parent, is_left);
+			return ft::make_pair(iterator(&_nodes, node), true);
+		}
+
+		// make() is only called when the key is missing
+		template <typename K, typename Maker>
+		ft::pair<iterator, bool> try_emplace(const K& k, const Maker& make)
+		{
+			index_type	parent;
+			bool		is_left;
+			index_type	node = find_unique_position(k, parent, is_left);
+
+			if (node)
+				return ft::make_pair(iterator(&_nodes, node), false);
+			node = link_node(create_node(make()), parent, is_left);
+			return ft::make_pair(iterator(&_nodes, node), true);
+		}
+
+		// links val next to the hint when it belongs right before or after it,
+		// otherwise falls back to a full descent
+		iterator insert(iterator position, const value_type& val)
+		{
+			const key_type&	k = key_of_value()(val);
+			index_type		hint = position.index();
+			index_type		near;
+
+			if (_size == 0)
+				return insert(val).first;
+			if (hint == 0)
+			{
+				near = rightmost();
+				if (_comp(key(near), k))
+					return iterator(&_nodes, link_node(create_node(val), near, false));
+				return insert(val).first;
+			}
+			if (_comp(k, key(hint)))
+			{
+				near = (--position).index();
+				if (near == 0 || _comp(key(near), k))
+				{
+					if (!_nodes[hint].left)
+						return iterator(&_nodes, link_node(create_node(val), hint, true));
+					return iterator(&_nodes, link_node(create_node(val), near, false));
+				}
+				return insert(val).first;
+			}
+			if (_comp(key(hint), k))
+			{
+				near = (++position).index();
+				if (near == 0 || _comp(k, key(near)))
+				{
+					if (!_nodes[hint].right)
+						return iterator(&_nodes, link_node(create_node(val), hint, false));
+					return iterator(&_nodes, link_node(create_node(val), near, true));
+				}
+				return insert(val).first;
+			}
+			return iterator(&_nodes, hint);
+		}
+
+		template <typename InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			for (InputIterator it = first; it != last; it++)
+				insert(end(), *it);
+		}
+
+		size_type erase(iterator position)
+		{
+			index_type	node = position.index();
+			index_type	parent;
+			index_type	child;
+			index_type	next;
+			index_type	retrace;
+			bool		left_side;
+
+			if (_size == 0 || node == 0)
+				return 0;
+			if (_size == 1)
+			{
+				set_leftmost(0);
+				_nodes[0].right = 0;
+			}
+			else if (node == leftmost())
+				set_leftmost((++iterator(&_nodes, node)).index());
+			else if (node == rightmost())
+				_nodes[0].right = (--iterator(&_nodes, node)).index();
+			parent = _nodes[node].parent();
+			if (_nodes[node].left && _nodes[node].right)
+			{
+				// the successor takes the place of the node
+				for (next = _nodes[node].right; _nodes[next].left; next = _nodes[next].left) {}
+				if (next == _nodes[node].right)
+				{
+					retrace = next;
+					left_side = false;
+				}
+				else
+				{
+					retrace = _nodes[next].parent();
+					left_side = true;
+					child = _nodes[next].right;
+					_nodes[retrace].left = child;
+					if (child)
+						_nodes[child].set_parent(retrace);
+					_nodes[next].right = _nodes[node].right;
+					_nodes[_nodes[node].right].set_parent(next);
+				}
+				_nodes[next].left = _nodes[node].left;
+				_nodes[_nodes[node].left].set_parent(next);
+				_nodes[next].set_balance(_nodes[node].balance());
+				_nodes[next].set_parent(parent);
+				replace_child(parent, node, next);
+			}
+			else
+			{
+				child = _nodes[node].left ? _nodes[node].left : _nodes[node].right;
+				retrace = parent;
+				left_side = parent && _nodes[parent].left == node;
+				replace_child(parent, node, child);
+				if (child)
+					_nodes[child].set_parent(parent);
+			}
+			destroy_node(node);
+			--_size;
+			erase_rebalance(retrace, left_side);
+			return 1;
+		}
+
+		// slots do not move, so the next iterator stays valid
+		size_type erase(iterator first, iterator last)
+		{
+			size_type n = 0;
+
+			while (first != last)
+				n += erase(first++);
+			return n;
+		}
+
+		void swap(compact_tree& x)
+		{
+			key_compare	tmp_comp = _comp;
+			index_type	tmp_free = _free;
+			size_type	tmp_size = _size;
+
+			_comp = x._comp;
+			_free = x._free;
+			_size = x._size;
+
+			x._comp = tmp_comp;
+			x._free = tmp_free;
+			x._size = tmp_size;
+
+			_nodes.swap(x._nodes);
+		}
+
+		// keeps the capacity
+		void clear()
+		{
+			_nodes.clear();
+			_nodes.push_back(node_type());
+			_free = 0;
+			_size = 0;
+		}
+
+		/* operations */
+		template <typename K>
+		iterator		find(const K& k) { return iterator(&_nodes, find_node(k)); }
+		template <typename K>
+		const_iterator	find(const K& k) const { return const_iterator(nodes(), find_node(k)); }
+
+		template <typename K>
+		size_type		count(const K& k) const { return find_node(k) != 0; }
+
+		template <typename K>
+		iterator		lower_bound(const K& k) { return iterator(&_nodes, lower_bound_node(k)); }
+		template <typename K>
+		const_iterator	lower_bound(const K& k) const { return const_iterator(nodes(), lower_bound_node(k)); }
+
+		template <typename K>
+		iterator		upper_bound(const K& k) { return iterator(&_nodes, upper_bound_node(k)); }
+		template <typename K>
+		const_iterator	upper_bound(const K& k) const { return const_iterator(nodes(), upper_bound_node(k)); }
+
+		template <typename K>
+		ft::pair<iterator, iterator> equal_range(const K& k)
+		{ return ft::make_pair(lower_bound(k), upper_bound(k)); }
+		template <typename K>
+		ft::pair<const_iterator, const_iterator> equal_range(const K& k) const
+		{ return ft::make_pair(lower_bound(k), upper_bound(k)); }
+
+		/* observers */
+		key_compare	key_comp() const { return _comp; }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _nodes.get_allocator(); }
+
+	private:
+		/* private memeber function */
+		node_vector*	nodes() const { return const_cast<node_vector*>(&_nodes); }
+
+		const key_type&	key(index_type i) const { return key_of_value()(_nodes[i].value()); }
+
+		// the header: left is the root, parent the leftmost node and right
+		// the rightmost one
+		index_type	root() const { return _nodes[0].left; }
+		index_type	leftmost() const { return _nodes[0].parent(); }
+		index_type	rightmost() const { return _nodes[0].right; }
+		void		set_leftmost(index_type i) { _nodes[0].set_parent(i); }
+
+		template <typename K>
+		index_type	find_node(const K& k) const
+		{
+			const node_type*	n = _nodes.begin().base();
+			index_type			i = n[0].left;
+
+			while (i)
+			{
+				if (_comp(k, key_of_value()(n[i].value())))
+					i = n[i].left;
+				else if (_comp(key_of_value()(n[i].value()), k))
+					i = n[i].right;
+				else
+					return i;
+			}
+			return 0;
+		}
+
+		template <typename K>
+		index_type	lower_bound_node(const K& k) const
+		{
+			const node_type*	n = _nodes.begin().base();
+			index_type			i = n[0].left;
+			index_type			res = 0;
+
+			while (i)
+			{
+				if (!_comp(key_of_value()(n[i].value()), k))
+				{
+					res = i;
+					i = n[i].left;
+				}
+				else
+					i = n[i].right;
+			}
+			return res;
+		}
+
+		template <typename K>
+		index_type	upper_bound_node(const K& k) const
+		{
+			const node_type*	n = _nodes.begin().base();
+			index_type			i = n[0].left;
+			index_type			res = 0;
+
+			while (i)
+			{
+				if (_comp(k, key_of_value()(n[i].value())))
+				{
+					res = i;
+					i = n[i].left;
+				}
+				else
+					i = n[i].right;
+			}
+			return res;
+		}
+
+		template <typename K>
+		index_type	find_unique_position(const K& k, index_type& parent, bool& is_left) const
+		{
+			index_type i = root();
+
+			parent = 0;
+			is_left = true;
+			while (i)
+			{
+				parent = i;
+				if (_comp(k, key(i)))
+				{
+					is_left = true;
+					i = _nodes[i].left;
+				}
+				else if (_comp(key(i), k))
+				{
+					is_left = false;
+					i = _nodes[i].right;
+				}
+				else
+					return i;
+			}
+			return 0;
+		}
+
+		// a free slot or a new one at the back, the slot goes back to the
+		// freelist if the value throws
+		index_type	create_node(const value_type& val)
+		{
+			index_type i = _free;
+
+			if (i)
+				_free = _nodes[i].left;
+			else
+			{
+				if (_nodes.size() > node_type::index_mask)
+					throw (std::length_error("compact_tree: out of indices"));
+				_nodes.push_back(node_type());
+				i = static_cast<index_type>(_nodes.size() - 1);
+			}
+			try
+			{
+				_value_alloc.construct(&_nodes[i].value(), val);
+			}
+			catch (...)
+			{
+				_nodes[i].left = _free;
+				_free = i;
+				throw;
+			}
+			_nodes[i].left = 0;
+			_nodes[i].right = 0;
+			_nodes[i].set_free(false);
+			_nodes[i].set_balance(0);
+			return i;
+		}
+
+		void	destroy_node(index_type i)
+		{
+			_value_alloc.destroy(&_nodes[i].value());
+			_nodes[i].set_free(true);
+			_nodes[i].right = 0;
+			_nodes[i].left = _free;
+			_free = i;
+		}
+
+		index_type	link_node(index_type node, index_type parent, bool is_left)
+		{
+			_nodes[node].set_parent(parent);
+			if (!parent)
+			{
+				_nodes[0].left = node;
+				set_leftmost(node);
+				_nodes[0].right = node;
+			}
+			else if (is_left)
+			{
+				_nodes[parent].left = node;
+				if (parent == leftmost())
+					set_leftmost(node);
+			}
+			else
+			{
+				_nodes[parent].right = node;
+				if (parent == rightmost())
+					_nodes[0].right = node;
+			}
+			++_size;
+			insert_rebalance(node);
+			return node;
+		}
+
+		void	replace_child(index_type parent, index_type old, index_type node)
+		{
+			if (!parent)
+				_nodes[0].left = node;
+			else if (_nodes[parent].left == old)
+				_nodes[parent].left = node;
+			else
+				_nodes[parent].right = node;
+		}
+
+		/* rotations */
+		// z is the taller child of x, they return the new root of the
+		// subtree, which the caller links to the old parent of x
+		index_type	rotate_left(index_type x, index_type z)
+		{
+			index_type inner = _nodes[z].left;
+
+			_nodes[x].right = inner;
+			if (inner)
+				_nodes[inner].set_parent(x);
+			_nodes[z].left = x;
+			_nodes[x].set_parent(z);
+			if (_nodes[z].balance() == 0)
+			{
+				_nodes[x].set_balance(1);
+				_nodes[z].set_balance(-1);
+			}
+			else
+			{
+				_nodes[x].set_balance(0);
+				_nodes[z].set_balance(0);
+			}
+			return z;
+		}
+
+		index_type	rotate_right(index_type x, index_type z)
+		{
+			index_type inner = _nodes[z].right;
+
+			_nodes[x].left = inner;
+			if (inner)
+				_nodes[inner].set_parent(x);
+			_nodes[z].right = x;
+			_nodes[x].set_parent(z);
+			if (_nodes[z].balance() == 0)
+			{
+				_nodes[x].set_balance(-1);
+				_nodes[z].set_balance(1);
+			}
+			else
+			{
+				_nodes[x].set_balance(0);
+				_nodes[z].set_balance(0);
+			}
+			return z;
+		}
+
+		// z is the right child of x and leans left
+		index_type	rotate_right_left(index_type x, index_type z)
+		{
+			index_type	y = _nodes[z].left;
+			index_type	inner_left = _nodes[y].left;
+			index_type	inner_right = _nodes[y].right;
+			int			b = _nodes[y].balance();
+
+			_nodes[z].left = inner_right;
+			if (inner_right)
+				_nodes[inner_right].set_parent(z);
+			_nodes[y].right = z;
+			_nodes[z].set_parent(y);
+			_nodes[x].right = inner_left;
+			if (inner_left)
+				_nodes[inner_left].set_parent(x);
+			_nodes[y].left = x;
+			_nodes[x].set_parent(y);
+			_nodes[x].set_balance(b > 0 ? -1 : 0);
+			_nodes[z].set_balance(b < 0 ? 1 : 0);
+			_nodes[y].set_balance(0);
+			return y;
+		}
+
+		// z is the left child of x and leans right
+		index_type	rotate_left_right(index_type x, index_type z)
+		{
+			index_type	y = _nodes[z].right;
+			index_type	inner_left = _nodes[y].left;
+			index_type	inner_right = _nodes[y].right;
+			int			b = _nodes[y].balance();
+
+			_nodes[z].right = inner_left;
+			if (inner_left)
+				_nodes[inner_left].set_parent(z);
+			_nodes[y].left = z;
+			_nodes[z].set_parent(y);
+			_nodes[x].left = inner_right;
+			if (inner_right)
+				_nodes[inner_right].set_parent(x);
+			_nodes[y].right = x;
+			_nodes[x].set_parent(y);
+			_nodes[x].set_balance(b < 0 ? 1 : 0);
+			_nodes[z].set_balance(b > 0 ? -1 : 0);
+			_nodes[y].set_balance(0);
+			return y;
+		}
+
+		/* rebalance */
+		// node just grew its parent subtree by one, walk up until a balance
+		// absorbs it or one rotation restores the old height
+		void	insert_rebalance(index_type node)
+		{
+			index_type	x = _nodes[node].parent();
+			index_type	parent;
+			index_type	top;
+
+			for (; x; node = x, x = _nodes[x].parent())
+			{
+				int b = _nodes[x].balance();
+
+				if (node == _nodes[x].right)
+				{
+					if (b < 0)
+					{
+						_nodes[x].set_balance(0);
+						return ;
+					}
+					if (b == 0)
+					{
+						_nodes[x].set_balance(1);
+						continue ;
+					}
+					parent = _nodes[x].parent();
+					top = _nodes[node].balance() < 0 ? rotate_right_left(x, node) : rotate_left(x, node);
+				}
+				else
+				{
+					if (b > 0)
+					{
+						_nodes[x].set_balance(0);
+						return ;
+					}
+					if (b == 0)
+					{
+						_nodes[x].set_balance(-1);
+						continue ;
+					}
+					parent = _nodes[x].parent();
+					top = _nodes[node].balance() > 0 ? rotate_left_right(x, node) : rotate_right(x, node);
+				}
+				_nodes[top].set_parent(parent);
+				replace_child(parent, x, top);
+				return ;
+			}
+		}
+
+		// the left_side subtree of x just lost one level, walk up until a
+		// balance absorbs it or a rotation keeps the height
+		void	erase_rebalance(index_type x, bool left_side)
+		{
+			index_type	parent;
+			index_type	top;
+			index_type	z;
+			int			zb;
+
+			while (x)
+			{
+				int b = _nodes[x].balance();
+
+				parent = _nodes[x].parent();
+				top = x;
+				zb = 1;
+				if (left_side)
+				{
+					if (b == 0)
+					{
+						_nodes[x].set_balance(1);
+						return ;
+					}
+					if (b < 0)
+						_nodes[x].set_balance(0);
+					else
+					{
+						z = _nodes[x].right;
+						zb = _nodes[z].balance();
+						top = zb < 0 ? rotate_right_left(x, z) : rotate_left(x, z);
+					}
+				}
+				else
+				{
+					if (b == 0)
+					{
+						_nodes[x].set_balance(-1);
+						return ;
+					}
+					if (b > 0)
+						_nodes[x].set_balance(0);
+					else
+					{
+						z = _nodes[x].left;
+						zb = _nodes[z].balance();
+						top = zb > 0 ? rotate_left_right(x, z) : rotate_right(x, z);
+					}
+				}
+				if (top != x)
+				{
+					_nodes[top].set_parent(parent);
+					replace_child(parent, x, top);
+					if (zb == 0)
+						return ;
+				}
+				left_side = parent && _nodes[parent].left == top;
+				x = parent;
+			}
+		}
+	};
+}
+
+#endif
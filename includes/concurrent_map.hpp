@@ -0,0 +1,589 @@
+#ifndef CONCURRENT_MAP_HPP
+# define CONCURRENT_MAP_HPP
+
+# include <pthread.h>
+# include <memory>
+# include <cstddef>
+# include <stdexcept>
+# include "utils.hpp"
+# include "iterator.hpp"
+
+namespace ft
+{
+	/* skiplist node */
+	// the low bit of next[i] marks the node as erased at level i, so no
+	// link can be swung onto it or past it from there anymore. The array
+	// is allocated to the level of the node
+	template <typename T>
+	struct skiplist_node
+	{
+		typedef T	value_type;
+
+		// both the insert and the erase of a node must be done with it
+		// before it is retired, whichever is last retires it
+		static const int	inserted = 1;
+		static const int	unlinked = 2;
+
+		ft::aligned_storage<T>	storage;
+		skiplist_node*			limbo;
+		int						level;
+		int						state;
+		skiplist_node*			next[1];
+
+		value_type&	value() { return *storage.data(); }
+
+		static bool				marked(skiplist_node* p) { return reinterpret_cast<std::size_t>(p) & 1; }
+		static skiplist_node*	strip(skiplist_node* p) { return reinterpret_cast<skiplist_node*>(reinterpret_cast<std::size_t>(p) & ~static_cast<std::size_t>(1)); }
+		static skiplist_node*	mark(skiplist_node* p) { return reinterpret_cast<skiplist_node*>(reinterpret_cast<std::size_t>(p) | 1); }
+
+		skiplist_node*	load(int i) const { return __atomic_load_n(&next[i], __ATOMIC_ACQUIRE); }
+
+		bool			cas(int i, skiplist_node* expected, skiplist_node* desired)
+		{ return __atomic_compare_exchange_n(&next[i], &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); }
+
+		// the next node of the bottom level that is not erased
+		skiplist_node*	forward() const
+		{
+			skiplist_node* node = strip(load(0));
+
+			while (node && marked(node->load(0)))
+				node = strip(node->load(0));
+			return node;
+		}
+	};
+
+
+	/* concurrent map */
+	// a lock-free skip list: insert, erase and lookups from any number of
+	// threads at once, nothing ever blocks. Erase marks the links of a node
+	// before cutting them, so a concurrent insert cannot link after it, and
+	// any search that walks by a marked node helps cutting it out.
+	//
+	// Erased nodes are freed with epochs: a thread inside an operation is
+	// pinned to the global epoch it saw, which only moves on once every
+	// pinned thread has seen it. A node retired in epoch e was unreachable
+	// by then, so it is freed once the epoch reaches e + 2. Every call pins
+	// for its own duration; iterators and the references they give are only
+	// safe while the thread holds a guard, which pins it as long as it lives.
+	//
+	// clear(), the destructor and size() are not linearizable, clear() and
+	// the destructor need every other thread to be done with the map
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class concurrent_map
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		typedef Alloc											allocator_type;
+		typedef typename allocator_type::reference				reference;
+		typedef typename allocator_type::const_reference		const_reference;
+		typedef typename allocator_type::pointer				pointer;
+		typedef typename allocator_type::const_pointer			const_pointer;
+		typedef ft::skiplist_node<value_type>					node_type;
+		typedef ft::skiplist_iterator<value_type, node_type>	iterator;
+		typedef ft::skiplist_iterator<const value_type, node_type>	const_iterator;
+		typedef std::ptrdiff_t									difference_type;
+		typedef std::size_t										size_type;
+
+		// a level holds a quarter of the one below
+		static const int	max_level = 16;
+
+		// pins the calling thread, see above
+		class guard
+		{
+			const concurrent_map&	_map;
+
+		public:
+			explicit guard(const concurrent_map& m) : _map(m) { _map.pin(); }
+			~guard() { _map.unpin(); }
+
+		private:
+			guard(const guard&);
+			guard& operator=(const guard&);
+		};
+
+	private:
+		// one per thread using the map, handed back when the thread exits
+		// and reused by the next one. Only the owner touches depth, seed
+		// and the limbo lists, which hold what it retired in the last
+		// three epochs
+		struct record
+		{
+			record*			next;
+			int				in_use;
+			int				active;
+			unsigned long	epoch;
+			int				depth;
+			unsigned int	seed;
+			unsigned int	retired;
+			node_type*		limbo[3];
+			unsigned long	limbo_epoch[3];
+		};
+
+		typedef typename Alloc::template rebind<node_type*>::other	word_allocator_type;
+		typedef typename Alloc::template rebind<value_type>::other	value_allocator_type;
+		typedef typename Alloc::template rebind<record>::other		record_allocator_type;
+
+		// retires between two tries to move the epoch on
+		static const unsigned int	advance_period = 64;
+
+		key_compare				_comp;
+		allocator_type			_alloc;
+		node_type*				_head;
+		pthread_key_t			_key;
+		mutable record*			_records;
+		mutable unsigned long	_epoch;
+		size_type				_size;
+
+	public:
+		/* constructor */
+		explicit concurrent_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _comp(comp), _alloc(alloc), _head(NULL), _records(NULL), _epoch(0), _size(0)
+		{ init(); }
+
+		template <typename InputIterator>
+		concurrent_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _comp(comp), _alloc(alloc), _head(NULL), _records(NULL), _epoch(0), _size(0)
+		{
+			init();
+			insert(first, last);
+		}
+
+		/* destructor */
+		~concurrent_map()
+		{
+			record_allocator_type	record_alloc(_alloc);
+			record*					next;
+
+			clear();
+			deallocate_node(_head);
+			for (record* r = _records; r; r = next)
+			{
+				next = r->next;
+				for (int i = 0; i < 3; ++i)
+					free_limbo(r->limbo[i]);
+				record_alloc.deallocate(r, 1);
+			}
+			pthread_key_delete(_key);
+		}
+
+		/* iterators */
+		iterator		begin() { guard g(*this); return iterator(_head->forward()); }
+		const_iterator	begin() const { guard g(*this); return const_iterator(_head->forward()); }
+		iterator		end() { return iterator(NULL); }
+		const_iterator	end() const { return const_iterator(NULL); }
+
+		/* capacity */
+		bool		empty() const { return size() == 0; }
+		size_type	size() const { return __atomic_load_n(&_size, __ATOMIC_RELAXED); }
+		size_type	max_size() const { return _alloc.max_size(); }
+
+		/* modifiers */
+		// the iterator is only safe to use under a guard
+		ft::pair<iterator, bool>	insert(const value_type& val)
+		{
+			node_type*	preds[max_level];
+			node_type*	succs[max_level];
+			node_type*	node = NULL;
+			guard		g(*this);
+			int			level = random_level();
+
+			for (;;)
+			{
+				if (search(val.first, preds, succs))
+				{
+					if (node)
+						free_node(node);
+					return ft::make_pair(iterator(succs[0]), false);
+				}
+				if (!node)
+					node = create_node(val, level);
+				for (int i = 0; i < level; ++i)
+					node->next[i] = succs[i];
+				if (preds[0]->cas(0, succs[0], node))
+					break ;
+			}
+			__atomic_fetch_add(&_size, 1, __ATOMIC_RELAXED);
+			link_levels(node, preds, succs);
+			// an erase may have cut the node out before a level got linked
+			if (node_type::marked(node->load(0)))
+				search(val.first, preds, succs);
+			finish(node, node_type::inserted, node_type::unlinked);
+			return ft::make_pair(iterator(node), true);
+		}
+
+		template <typename InputIterator>
+		void	insert(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		void		erase(iterator position) { erase(position->first); }
+
+		// 1 when this call is the one that erased k
+		size_type	erase(const key_type& k)
+		{
+			node_type*	preds[max_level];
+			node_type*	succs[max_level];
+			node_type*	node;
+			node_type*	next;
+			guard		g(*this);
+
+			if (!search(k, preds, succs))
+				return 0;
+			node = succs[0];
+			for (int i = node->level - 1; i > 0; --i)
+			{
+				for (next = node->load(i); !node_type::marked(next); next = node->load(i))
+					node->cas(i, next, node_type::mark(next));
+			}
+			// the bottom mark is the erase itself, only one thread gets it
+			for (next = node->load(0); ; next = node->load(0))
+			{
+				if (node_type::marked(next))
+					return 0;
+				if (node->cas(0, next, node_type::mark(next)))
+					break ;
+			}
+			__atomic_fetch_sub(&_size, 1, __ATOMIC_RELAXED);
+			search(k, preds, succs);
+			finish(node, node_type::unlinked, node_type::inserted);
+			return 1;
+		}
+
+		// not safe against any concurrent use
+		void	clear()
+		{
+			node_type* next;
+
+			for (node_type* node = node_type::strip(_head->next[0]); node; node = next)
+			{
+				next = node_type::strip(node->next[0]);
+				free_node(node);
+			}
+			for (int i = 0; i < max_level; ++i)
+				_head->next[i] = NULL;
+			_size = 0;
+		}
+
+		/* observers */
+		key_compare	key_comp() const { return _comp; }
+
+		/* operations */
+		iterator		find(const key_type& k) { return iterator(find_node(k)); }
+		const_iterator	find(const key_type& k) const { return const_iterator(find_node(k)); }
+
+		size_type		count(const key_type& k) const { return find_node(k) != NULL; }
+
+		iterator		lower_bound(const key_type& k) { return iterator(bound_node(k, false)); }
+		const_iterator	lower_bound(const key_type& k) const { return const_iterator(bound_node(k, false)); }
+
+		iterator		upper_bound(const key_type& k) { return iterator(bound_node(k, true)); }
+		const_iterator	upper_bound(const key_type& k) const { return const_iterator(bound_node(k, true)); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		concurrent_map(const concurrent_map&);
+		concurrent_map& operator=(const concurrent_map&);
+
+		void	init()
+		{
+			_head = allocate_node(max_level);
+			for (int i = 0; i < max_level; ++i)
+				_head->next[i] = NULL;
+			if (pthread_key_create(&_key, &concurrent_map::release_record) != 0)
+			{
+				deallocate_node(_head);
+				throw (std::runtime_error("concurrent_map: no thread key left"));
+			}
+		}
+
+		/* skip list */
+		// preds and succs of k at every level, marked nodes on the way are
+		// cut out. Starts over when a cut fails, the predecessor changed
+		bool	search(const key_type& k, node_type** preds, node_type** succs)
+		{
+			node_type*	pred;
+			node_type*	curr;
+			node_type*	succ;
+			int			i;
+
+			for (;;)
+			{
+				pred = _head;
+				for (i = max_level - 1; i >= 0; --i)
+				{
+					curr = node_type::strip(pred->load(i));
+					while (curr)
+					{
+						succ = curr->load(i);
+						if (node_type::marked(succ))
+						{
+							if (!pred->cas(i, curr, node_type::strip(succ)))
+								break ;
+							curr = node_type::strip(succ);
+						}
+						else if (_comp(curr->value().first, k))
+						{
+							pred = curr;
+							curr = succ;
+						}
+						else
+							break ;
+					}
+					if (curr && node_type::marked(curr->load(i)))
+						break ;
+					preds[i] = pred;
+					succs[i] = curr;
+				}
+				if (i < 0)
+					return succs[0] && !_comp(k, succs[0]->value().first);
+			}
+		}
+
+		// links the levels above the bottom one, gives up as soon as the
+		// node gets erased
+		void	link_levels(node_type* node, node_type** preds, node_type** succs)
+		{
+			const key_type&	k = node->value().first;
+			node_type*		next;
+
+			for (int i = 1; i < node->level; ++i)
+			{
+				for (;;)
+				{
+					next = node->load(i);
+					if (node_type::marked(next))
+						return ;
+					if (next != succs[i] && !node->cas(i, next, succs[i]))
+						return ;
+					if (preds[i]->cas(i, succs[i], node))
+						break ;
+					search(k, preds, succs);
+					if (succs[0] != node)
+						return ;
+				}
+			}
+		}
+
+		// read only walk, erased nodes are stepped over and left alone
+		node_type*	bound_node(const key_type& k, bool upper) const
+		{
+			node_type*	pred = _head;
+			node_type*	curr = NULL;
+			node_type*	succ;
+			guard		g(*this);
+
+			for (int i = max_level - 1; i >= 0; --i)
+			{
+				curr = node_type::strip(pred->load(i));
+				while (curr)
+				{
+					succ = curr->load(i);
+					if (node_type::marked(succ))
+						curr = node_type::strip(succ);
+					else if (upper ? !_comp(k, curr->value().first) : _comp(curr->value().first, k))
+					{
+						pred = curr;
+						curr = succ;
+					}
+					else
+						break ;
+				}
+			}
+			return curr;
+		}
+
+		node_type*	find_node(const key_type& k) const
+		{
+			node_type* node = bound_node(k, false);
+
+			return (node && !_comp(k, node->value().first)) ? node : NULL;
+		}
+
+		int		random_level() const
+		{
+			record*			r = get_record();
+			unsigned int	x = r->seed;
+			int				level = 1;
+
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			r->seed = x;
+			for (; (x & 3) == 0 && level < max_level; x >>= 2)
+				++level;
+			return level;
+		}
+
+		/* nodes */
+		static size_type	node_words(int level)
+		{ return (offsetof(node_type, next) + level * sizeof(node_type*) + sizeof(node_type*) - 1) / sizeof(node_type*); }
+
+		node_type*	allocate_node(int level)
+		{
+			word_allocator_type	words(_alloc);
+			node_type*			node = reinterpret_cast<node_type*>(words.allocate(node_words(level)));
+
+			node->limbo = NULL;
+			node->level = level;
+			node->state = 0;
+			return node;
+		}
+
+		void	deallocate_node(node_type* node)
+		{
+			word_allocator_type words(_alloc);
+
+			words.deallocate(reinterpret_cast<node_type**>(node), node_words(node->level));
+		}
+
+		node_type*	create_node(const value_type& val, int level)
+		{
+			value_allocator_type	value_alloc(_alloc);
+			node_type*				node = allocate_node(level);
+
+			try
+			{
+				value_alloc.construct(&node->value(), val);
+			}
+			catch (...)
+			{
+				deallocate_node(node);
+				throw;
+			}
+			return node;
+		}
+
+		void	free_node(node_type* node)
+		{
+			value_allocator_type value_alloc(_alloc);
+
+			value_alloc.destroy(&node->value());
+			deallocate_node(node);
+		}
+
+		void	free_limbo(node_type* node)
+		{
+			node_type* next;
+
+			for (; node; node = next)
+			{
+				next = node->limbo;
+				free_node(node);
+			}
+		}
+
+		/* epochs */
+		record*	get_record() const
+		{
+			record*	r = static_cast<record*>(pthread_getspecific(_key));
+			int		expected;
+
+			if (r)
+				return r;
+			for (r = __atomic_load_n(&_records, __ATOMIC_ACQUIRE); r; r = r->next)
+			{
+				expected = 0;
+				if (__atomic_compare_exchange_n(&r->in_use, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+					break ;
+			}
+			if (!r)
+				r = new_record();
+			pthread_setspecific(_key, r);
+			return r;
+		}
+
+		record*	new_record() const
+		{
+			record_allocator_type	record_alloc(_alloc);
+			record*					r = record_alloc.allocate(1);
+
+			r->in_use = 1;
+			r->active = 0;
+			r->epoch = 0;
+			r->depth = 0;
+			r->seed = static_cast<unsigned int>(reinterpret_cast<std::size_t>(r) >> 4) | 1;
+			r->retired = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				r->limbo[i] = NULL;
+				r->limbo_epoch[i] = 0;
+			}
+			r->next = __atomic_load_n(&_records, __ATOMIC_ACQUIRE);
+			while (!__atomic_compare_exchange_n(&_records, &r->next, r, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {}
+			return r;
+		}
+
+		// runs when a thread that used the map exits
+		static void	release_record(void* r)
+		{ __atomic_store_n(&static_cast<record*>(r)->in_use, 0, __ATOMIC_RELEASE); }
+
+		// active goes up before the epoch is read: an advance that misses
+		// it happened before the read, one that sees it waits for us
+		void	pin() const
+		{
+			record* r = get_record();
+
+			if (r->depth++ == 0)
+			{
+				__atomic_store_n(&r->active, 1, __ATOMIC_SEQ_CST);
+				__atomic_store_n(&r->epoch, __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+			}
+		}
+
+		void	unpin() const
+		{
+			record* r = get_record();
+
+			if (--r->depth == 0)
+				__atomic_store_n(&r->active, 0, __ATOMIC_RELEASE);
+		}
+
+		void	finish(node_type* node, int done, int other)
+		{
+			if (__atomic_fetch_or(&node->state, done, __ATOMIC_ACQ_REL) & other)
+				retire(node);
+		}
+
+		// the limbo list of epoch e is reused at e + 3, what it still holds
+		// was retired at e and can go
+		void	retire(node_type* node)
+		{
+			record*			r = get_record();
+			unsigned long	e = __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST);
+			int				b = e % 3;
+
+			if (r->limbo_epoch[b] != e)
+			{
+				free_limbo(r->limbo[b]);
+				r->limbo[b] = NULL;
+				r->limbo_epoch[b] = e;
+			}
+			node->limbo = r->limbo[b];
+			r->limbo[b] = node;
+			if (++r->retired % advance_period == 0)
+				try_advance();
+		}
+
+		void	try_advance() const
+		{
+			unsigned long e = __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST);
+
+			for (record* r = __atomic_load_n(&_records, __ATOMIC_ACQUIRE); r; r = r->next)
+			{
+				if (__atomic_load_n(&r->active, __ATOMIC_SEQ_CST) && __atomic_load_n(&r->epoch, __ATOMIC_SEQ_CST) != e)
+					return ;
+			}
+			__atomic_compare_exchange_n(&_epoch, &e, e + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,362 @@
+#ifndef FLAT_MAP_HPP
+# define FLAT_MAP_HPP
+
+# include <memory>
+# include <algorithm>
+# include "vector.hpp"
+
+namespace ft
+{
+	// ft::map on two sorted ft::vectors, one of keys and one of mapped
+	// values, so a lookup only touches the keys. Any insert or erase
+	// invalidates iterators, and costs a shift of the tail
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class flat_map
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		class	value_compare
+		{
+			friend class flat_map;
+		protected:
+			key_compare comp;
+			value_compare (key_compare c) : comp(c) {}
+		public:
+			bool operator() (const value_type& x, const value_type& y) const
+			{ return (comp(x.first, y.first)); }
+		};
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef ft::flat_map_iterator<key_type, mapped_type, mapped_type>		iterator;
+		typedef ft::flat_map_iterator<key_type, mapped_type, const mapped_type>	const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		typedef ft::pair<key_type, mapped_type>									entry_type;
+		typedef ft::vector<key_type, typename Alloc::template rebind<key_type>::other>			key_vector;
+		typedef ft::vector<mapped_type, typename Alloc::template rebind<mapped_type>::other>	mapped_vector;
+		typedef ft::vector<entry_type, typename Alloc::template rebind<entry_type>::other>		entry_vector;
+
+		struct entry_compare
+		{
+			key_compare comp;
+
+			entry_compare(const key_compare& c) : comp(c) {}
+			bool operator()(const entry_type& x, const entry_type& y) const { return comp(x.first, y.first); }
+		};
+
+		key_compare		_key_comp;
+		value_compare	_value_comp;
+		allocator_type	_alloc;
+		key_vector		_keys;
+		mapped_vector	_mapped;
+
+	public:
+		/* constructor */
+		explicit flat_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _keys(alloc), _mapped(alloc) {}
+
+		template <typename InputIterator>
+		flat_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _keys(alloc), _mapped(alloc)
+		{ insert(first, last); }
+
+		flat_map(const flat_map& other)
+		: _key_comp(other._key_comp), _value_comp(other._value_comp), _alloc(other._alloc), _keys(other._keys), _mapped(other._mapped) {}
+
+		/* destructor */
+		~flat_map() {}
+
+		/* assignment operator */
+		flat_map& operator=(const flat_map& m)
+		{
+			if (this != &m)
+			{
+				_key_comp = m._key_comp;
+				_value_comp = m._value_comp;
+				_keys = m._keys;
+				_mapped = m._mapped;
+			}
+			return *this;
+		}
+
+		/* iterators */
+		iterator				begin() { return make_iterator(0); }
+		const_iterator			begin() const { return make_iterator(0); }
+		iterator				end() { return make_iterator(size()); }
+		const_iterator			end() const { return make_iterator(size()); }
+		reverse_iterator		rbegin() { return reverse_iterator(end()); }
+		const_reverse_iterator	rbegin() const { return const_reverse_iterator(end()); }
+		reverse_iterator		rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator	rend() const { return const_reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _keys.empty(); }
+		size_type	size() const { return _keys.size(); }
+		size_type	max_size() const { return std::min(_keys.max_size(), _mapped.max_size()); }
+		size_type	capacity() const { return _keys.capacity(); }
+
+		void		reserve(size_type n)
+		{
+			_keys.reserve(n);
+			_mapped.reserve(n);
+		}
+
+		/* element access */
+		mapped_type& operator[] (const key_type& k) { return try_emplace(k).first->second; }
+
+		/* modifiers */
+		ft::pair<iterator, bool>	insert(const value_type& val) { return try_emplace(val.first, val.second); }
+
+		// the hint is used when k belongs right before it
+		iterator					insert(iterator hint, const value_type& val)
+		{
+			size_type i = hint.base() - key_data();
+
+			if ((i == size() || _key_comp(val.first, _keys[i]))
+				&& (i == 0 || _key_comp(_keys[i - 1], val.first)))
+				return insert_at(i, val.first, val.second);
+			return insert(val).first;
+		}
+
+		// sorts the new values once and merges them with ours, the first of
+		// equal keys wins like in a loop of single inserts
+		template <typename InputIterator>
+		void						insert(InputIterator first, InputIterator last)
+		{
+			entry_vector	in(_alloc);
+			size_type		n = 0;
+
+			for (; first != last; ++first)
+				in.push_back(entry_type((*first).first, (*first).second));
+			if (in.empty())
+				return ;
+			std::stable_sort(in.begin(), in.end(), entry_compare(_key_comp));
+			for (size_type i = 1; i < in.size(); ++i)
+			{
+				if (_key_comp(in[n].first, in[i].first))
+					in[++n] = in[i];
+			}
+			in.erase(in.begin() + n + 1, in.end());
+			if (empty() || _key_comp(_keys.back(), in.front().first))
+			{
+				reserve(size() + in.size());
+				for (size_type i = 0; i < in.size(); ++i)
+				{
+					_keys.push_back(in[i].first);
+					_mapped.push_back(in[i].second);
+				}
+				return ;
+			}
+			merge_sorted(in);
+		}
+
+		ft::pair<iterator, bool>	try_emplace(const key_type& k) { return try_emplace(k, mapped_type()); }
+
+		ft::pair<iterator, bool>	try_emplace(const key_type& k, const mapped_type& obj)
+		{
+			size_type i = lower_index(k);
+
+			if (i != size() && !_key_comp(k, _keys[i]))
+				return ft::make_pair(make_iterator(i), false);
+			return ft::make_pair(insert_at(i, k, obj), true);
+		}
+
+		ft::pair<iterator, bool>	insert_or_assign(const key_type& k, const mapped_type& obj)
+		{
+			ft::pair<iterator, bool> p = try_emplace(k, obj);
+			if (!p.second)
+				p.first->second = obj;
+			return p;
+		}
+
+		void		erase(iterator position)
+		{
+			size_type i = position.base() - key_data();
+
+			_keys.erase(_keys.begin() + i);
+			_mapped.erase(_mapped.begin() + i);
+		}
+
+		size_type	erase(const key_type& k)
+		{
+			size_type i = lower_index(k);
+
+			if (i == size() || _key_comp(k, _keys[i]))
+				return 0;
+			erase(make_iterator(i));
+			return 1;
+		}
+
+		void		erase(iterator first, iterator last)
+		{
+			size_type i = first.base() - key_data();
+			size_type j = last.base() - key_data();
+
+			_keys.erase(_keys.begin() + i, _keys.begin() + j);
+			_mapped.erase(_mapped.begin() + i, _mapped.begin() + j);
+		}
+
+		void	swap(flat_map& x)
+		{
+			std::swap(_key_comp, x._key_comp);
+			std::swap(_value_comp, x._value_comp);
+			std::swap(_alloc, x._alloc);
+			_keys.swap(x._keys);
+			_mapped.swap(x._mapped);
+		}
+
+		void	clear()
+		{
+			_keys.clear();
+			_mapped.clear();
+		}
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _value_comp; }
+
+		/* operations */
+		iterator		find(const key_type& k) { return make_iterator(find_index(k)); }
+		const_iterator	find(const key_type& k) const { return make_iterator(find_index(k)); }
+
+		size_type		count(const key_type& k) const { return find_index(k) != size(); }
+
+		iterator		lower_bound(const key_type& k) { return make_iterator(lower_index(k)); }
+		const_iterator	lower_bound(const key_type& k) const { return make_iterator(lower_index(k)); }
+
+		iterator		upper_bound(const key_type& k) { return make_iterator(upper_index(k)); }
+		const_iterator	upper_bound(const key_type& k) const { return make_iterator(upper_index(k)); }
+
+		ft::pair<iterator, iterator> equal_range(const key_type& k)
+		{
+			size_type i = lower_index(k);
+			size_type j = (i != size() && !_key_comp(k, _keys[i])) ? i + 1 : i;
+
+			return ft::make_pair(make_iterator(i), make_iterator(j));
+		}
+
+		ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+			size_type j = (i != size() && !_key_comp(k, _keys[i])) ? i + 1 : i;
+
+			return ft::make_pair(make_iterator(i), make_iterator(j));
+		}
+
+		/* allocator */
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		const key_type*		key_data() const { return _keys.begin().base(); }
+		mapped_type*		mapped_data() { return _mapped.begin().base(); }
+		const mapped_type*	mapped_data() const { return _mapped.begin().base(); }
+
+		iterator		make_iterator(size_type i) { return iterator(key_data() + i, mapped_data() + i); }
+		const_iterator	make_iterator(size_type i) const { return const_iterator(key_data() + i, mapped_data() + i); }
+
+		size_type	lower_index(const key_type& k) const
+		{ return ft::branchless_lower_bound(key_data(), size(), k, _key_comp) - key_data(); }
+
+		size_type	upper_index(const key_type& k) const
+		{ return ft::branchless_upper_bound(key_data(), size(), k, _key_comp) - key_data(); }
+
+		size_type	find_index(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+
+			return (i != size() && !_key_comp(k, _keys[i])) ? i : size();
+		}
+
+		// the shifted insert of both vectors, the key goes back out if the
+		// mapped value throws
+		iterator	insert_at(size_type i, const key_type& k, const mapped_type& obj)
+		{
+			_keys.insert(_keys.begin() + i, k);
+			try
+			{
+				_mapped.insert(_mapped.begin() + i, obj);
+			}
+			catch (...)
+			{
+				_keys.erase(_keys.begin() + i);
+				throw;
+			}
+			return make_iterator(i);
+		}
+
+		// in is sorted without duplicates, our value wins on equal keys
+		void	merge_sorted(const entry_vector& in)
+		{
+			key_vector		keys(_keys.get_allocator());
+			mapped_vector	mapped(_mapped.get_allocator());
+			size_type		i = 0;
+			size_type		j = 0;
+
+			keys.reserve(size() + in.size());
+			mapped.reserve(size() + in.size());
+			while (i < size() || j < in.size())
+			{
+				if (j == in.size() || (i < size() && !_key_comp(in[j].first, _keys[i])))
+				{
+					if (j < in.size() && !_key_comp(_keys[i], in[j].first))
+						++j;
+					keys.push_back(_keys[i]);
+					mapped.push_back(_mapped[i]);
+					++i;
+				}
+				else
+				{
+					keys.push_back(in[j].first);
+					mapped.push_back(in[j].second);
+					++j;
+				}
+			}
+			_keys.swap(keys);
+			_mapped.swap(mapped);
+		}
+	};
+
+	/* relational operators */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator==(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator!=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	void swap(flat_map<Key, T, Compare, Alloc>& lhs, flat_map<Key, T, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef FLAT_SET_HPP
+# define FLAT_SET_HPP
+
+# include <memory>
+# include <algorithm>
+# include "vector.hpp"
+
+namespace ft
+{
+	// sorted unique keys in one ft::vector, insert and erase invalidate
+	// iterators, see flat_map.hpp
+	template <typename Key, typename Compare = ft::less<Key>, typename Alloc = std::allocator<Key> >
+	class flat_set
+	{
+	public:
+		typedef Key										key_type;
+		typedef Key										value_type;
+		typedef Compare									key_compare;
+		typedef Compare									value_compare;
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef ft::vector<key_type, allocator_type>							vector_type;
+		// keys are never modified in place
+		typedef typename vector_type::const_iterator							iterator;
+		typedef typename vector_type::const_iterator							const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		key_compare		_key_comp;
+		vector_type		_keys;
+
+	public:
+		/* constructor */
+		explicit flat_set(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _keys(alloc) {}
+
+		template <typename InputIterator>
+		flat_set(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _keys(alloc)
+		{ insert(first, last); }
+
+		flat_set(const flat_set& other) : _key_comp(other._key_comp), _keys(other._keys) {}
+
+		/* destructor */
+		~flat_set() {}
+
+		/* assignment operator */
+		flat_set& operator=(const flat_set& s)
+		{
+			if (this != &s)
+			{
+				_key_comp = s._key_comp;
+				_keys = s._keys;
+			}
+			return *this;
+		}
+
+		/* iterators */
+		iterator			begin() const { return _keys.begin(); }
+		iterator			end() const { return _keys.end(); }
+		reverse_iterator	rbegin() const { return reverse_iterator(end()); }
+		reverse_iterator	rend() const { return reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _keys.empty(); }
+		size_type	size() const { return _keys.size(); }
+		size_type	max_size() const { return _keys.max_size(); }
+		size_type	capacity() const { return _keys.capacity(); }
+		void		reserve(size_type n) { _keys.reserve(n); }
+
+		/* modifiers */
+		ft::pair<iterator, bool> insert(const value_type& val)
+		{
+			size_type i = lower_index(val);
+
+			if (i != size() && !_key_comp(val, _keys[i]))
+				return ft::make_pair(begin() + i, false);
+			return ft::make_pair(iterator(_keys.insert(_keys.begin() + i, val)), true);
+		}
+
+		// the hint is used when val belongs right before it
+		iterator	insert(iterator hint, const value_type& val)
+		{
+			size_type i = hint - begin();
+
+			if ((i == size() || _key_comp(val, _keys[i]))
+				&& (i == 0 || _key_comp(_keys[i - 1], val)))
+				return _keys.insert(_keys.begin() + i, val);
+			return insert(val).first;
+		}
+
+		// sorts the new keys once and merges them with ours
+		template <typename InputIterator>
+		void		insert(InputIterator first, InputIterator last)
+		{
+			vector_type	in(_keys.get_allocator());
+			size_type	n = 0;
+
+			for (; first != last; ++first)
+				in.push_back(*first);
+			if (in.empty())
+				return ;
+			std::stable_sort(in.begin(), in.end(), _key_comp);
+			for (size_type i = 1; i < in.size(); ++i)
+			{
+				if (_key_comp(in[n], in[i]))
+					in[++n] = in[i];
+			}
+			in.erase(in.begin() + n + 1, in.end());
+			if (empty() || _key_comp(_keys.back(), in.front()))
+			{
+				_keys.reserve(size() + in.size());
+				for (size_type i = 0; i < in.size(); ++i)
+					_keys.push_back(in[i]);
+				return ;
+			}
+			merge_sorted(in);
+		}
+
+		void		erase(iterator position) { _keys.erase(_keys.begin() + (position - begin())); }
+
+		size_type	erase(const key_type& k)
+		{
+			size_type i = lower_index(k);
+
+			if (i == size() || _key_comp(k, _keys[i]))
+				return 0;
+			_keys.erase(_keys.begin() + i);
+			return 1;
+		}
+
+		void		erase(iterator first, iterator last)
+		{ _keys.erase(_keys.begin() + (first - begin()), _keys.begin() + (last - begin())); }
+
+		void	swap(flat_set& x)
+		{
+			std::swap(_key_comp, x._key_comp);
+			_keys.swap(x._keys);
+		}
+
+		void	clear() { _keys.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _key_comp; }
+
+		/* operations */
+		iterator	find(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+
+			return (i != size() && !_key_comp(k, _keys[i])) ? begin() + i : end();
+		}
+
+		size_type	count(const key_type& k) const { return find(k) != end(); }
+
+		iterator	lower_bound(const key_type& k) const { return begin() + lower_index(k); }
+		iterator	upper_bound(const key_type& k) const
+		{ return iterator(ft::branchless_upper_bound(data(), size(), k, _key_comp)); }
+
+		ft::pair<iterator, iterator> equal_range(const key_type& k) const
+		{
+			iterator it = lower_bound(k);
+
+			if (it != end() && !_key_comp(k, *it))
+				return ft::make_pair(it, it + 1);
+			return ft::make_pair(it, it);
+		}
+
+		/* allocator */
+		allocator_type get_allocator() const { return _keys.get_allocator(); }
+
+	private:
+		const key_type*	data() const { return _keys.begin().base(); }
+
+		size_type	lower_index(const key_type& k) const
+		{ return ft::branchless_lower_bound(data(), size(), k, _key_comp) - data(); }
+
+		// in is sorted without duplicates
+		void	merge_sorted(const vector_type& in)
+		{
+			vector_type	keys(_keys.get_allocator());
+			size_type	i = 0;
+			size_type	j = 0;
+
+			keys.reserve(size() + in.size());
+			while (i < size() || j < in.size())
+			{
+				if (j == in.size() || (i < size() && !_key_comp(in[j], _keys[i])))
+				{
+					if (j < in.size() && !_key_comp(_keys[i], in[j]))
+						++j;
+					keys.push_back(_keys[i++]);
+				}
+				else
+					keys.push_back(in[j++]);
+			}
+			_keys.swap(keys);
+		}
+	};
+
+	/* relational operators */
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator==(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator!=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator<(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator<=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator>(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename Compare, typename Alloc>
+	bool operator>=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename Compare, typename Alloc>
+	void swap(flat_set<Key, Compare, Alloc>& lhs, flat_set<Key, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
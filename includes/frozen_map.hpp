@@ -0,0 +1,369 @@
+#ifndef FROZEN_MAP_HPP
+# define FROZEN_MAP_HPP
+
+# include <memory>
+# include "map.hpp"
+# include "vector.hpp"
+# ifdef __AVX2__
+#  include <immintrin.h>
+# endif
+
+namespace ft
+{
+	/* frozen_block */
+	// how many keys of a block come before k (lower) or not after it
+	// (upper). A short last block is padded with copies of its last key,
+	// which is never counted, so every block is compared in full
+	template <typename Key, typename Compare>
+	struct frozen_block
+	{
+		static const std::size_t	size = 8;
+
+		static std::size_t	lower(const Key* block, const Key& k, const Compare& comp)
+		{
+			std::size_t n = 0;
+
+			for (std::size_t i = 0; i < size; ++i)
+				n += comp(block[i], k);
+			return n;
+		}
+
+		static std::size_t	upper(const Key* block, const Key& k, const Compare& comp)
+		{
+			std::size_t n = 0;
+
+			for (std::size_t i = 0; i < size; ++i)
+				n += !comp(k, block[i]);
+			return n;
+		}
+	};
+
+# ifdef __AVX2__
+	// one compare of the whole block for the integral keys ordered by <
+	template <>
+	struct frozen_block<int, ft::less<int> >
+	{
+		static const std::size_t	size = 8;
+
+		static std::size_t	lower(const int* block, const int& k, const ft::less<int>&)
+		{
+			__m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			__m256i before = _mm256_cmpgt_epi32(_mm256_set1_epi32(k), keys);
+
+			return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(before)));
+		}
+
+		static std::size_t	upper(const int* block, const int& k, const ft::less<int>&)
+		{
+			__m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			__m256i after = _mm256_cmpgt_epi32(keys, _mm256_set1_epi32(k));
+
+			return size - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(after)));
+		}
+	};
+
+#  ifdef __LP64__
+	template <>
+	struct frozen_block<long, ft::less<long> >
+	{
+		static const std::size_t	size = 8;
+
+		static std::size_t	lower(const long* block, const long& k, const ft::less<long>&)
+		{
+			__m256i key = _mm256_set1_epi64x(k);
+			__m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			__m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 4));
+
+			return __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, lo))))
+				+ __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, hi))));
+		}
+
+		static std::size_t	upper(const long* block, const long& k, const ft::less<long>&)
+		{
+			__m256i key = _mm256_set1_epi64x(k);
+			__m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			__m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 4));
+
+			return size - __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(lo, key))))
+				- __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(hi, key))));
+		}
+	};
+#  endif
+# endif
+
+
+	// a read only snapshot of a map built for lookups. The keys are kept
+	// sorted in blocks of 8 and the last key of every block goes to an
+	// index in eytzinger order: node i has its children at 2i and 2i + 1,
+	// so the top of the search shares a few cache lines and the nodes a few
+	// levels down can be prefetched before they are needed. The descent
+	// has no branch on the keys, and the block it ends in is compared at
+	// once. Iterators walk the sorted keys like those of ft::flat_map
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class frozen_map
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		class	value_compare
+		{
+			friend class frozen_map;
+		protected:
+			key_compare comp;
+			value_compare (key_compare c) : comp(c) {}
+		public:
+			bool operator() (const value_type& x, const value_type& y) const
+			{ return (comp(x.first, y.first)); }
+		};
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		// nothing is modified in place
+		typedef ft::flat_map_iterator<key_type, mapped_type, const mapped_type>	iterator;
+		typedef ft::flat_map_iterator<key_type, mapped_type, const mapped_type>	const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		typedef ft::frozen_block<key_type, key_compare>									block_type;
+		typedef ft::vector<key_type, typename Alloc::template rebind<key_type>::other>			key_vector;
+		typedef ft::vector<mapped_type, typename Alloc::template rebind<mapped_type>::other>	mapped_vector;
+
+		static const size_type	block_size = block_type::size;
+		// index nodes per cache line: node i * stride is log2(stride)
+		// levels below i
+		static const size_type	prefetch_stride = sizeof(key_type) < 64 ? 64 / sizeof(key_type) : 1;
+
+		key_compare		_key_comp;
+		value_compare	_value_comp;
+		allocator_type	_alloc;
+		key_vector		_keys;		// sorted, padded to whole blocks
+		mapped_vector	_mapped;
+		key_vector		_index;		// eytzinger order from 1, last key of each block
+
+	public:
+		/* constructor */
+		explicit frozen_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _keys(alloc), _mapped(alloc), _index(alloc) {}
+
+		// [first, last) must already be sorted by comp without equal keys,
+		// as the range of an ft::map is
+		template <typename InputIterator>
+		frozen_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _keys(alloc), _mapped(alloc), _index(alloc)
+		{
+			for (; first != last; ++first)
+			{
+				_keys.push_back((*first).first);
+				_mapped.push_back((*first).second);
+			}
+			build();
+		}
+
+		template <typename PoolPolicy, typename NodeUpdate>
+		explicit frozen_map(const ft::map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& m)
+		: _key_comp(m.key_comp()), _value_comp(m.key_comp()), _alloc(m.get_allocator()),
+			_keys(_alloc), _mapped(_alloc), _index(_alloc)
+		{
+			_keys.reserve(m.size() + block_size);
+			_mapped.reserve(m.size());
+			for (typename ft::map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>::const_iterator it = m.begin(); it != m.end(); ++it)
+			{
+				_keys.push_back(it->first);
+				_mapped.push_back(it->second);
+			}
+			build();
+		}
+
+		frozen_map(const frozen_map& other)
+		: _key_comp(other._key_comp), _value_comp(other._value_comp), _alloc(other._alloc),
+			_keys(other._keys), _mapped(other._mapped), _index(other._index) {}
+
+		/* destructor */
+		~frozen_map() {}
+
+		/* assignment operator */
+		frozen_map& operator=(const frozen_map& m)
+		{
+			if (this != &m)
+			{
+				_key_comp = m._key_comp;
+				_value_comp = m._value_comp;
+				_keys = m._keys;
+				_mapped = m._mapped;
+				_index = m._index;
+			}
+			return *this;
+		}
+
+		/* iterators */
+		const_iterator			begin() const { return make_iterator(0); }
+		const_iterator			end() const { return make_iterator(size()); }
+		const_reverse_iterator	rbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator	rend() const { return const_reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _mapped.empty(); }
+		size_type	size() const { return _mapped.size(); }
+		size_type	max_size() const { return std::min(_keys.max_size(), _mapped.max_size()); }
+
+		/* modifiers */
+		void	swap(frozen_map& x)
+		{
+			std::swap(_key_comp, x._key_comp);
+			std::swap(_value_comp, x._value_comp);
+			std::swap(_alloc, x._alloc);
+			_keys.swap(x._keys);
+			_mapped.swap(x._mapped);
+			_index.swap(x._index);
+		}
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _value_comp; }
+
+		/* operations */
+		const_iterator	find(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+
+			return (i != size() && !_key_comp(k, _keys[i])) ? make_iterator(i) : end();
+		}
+
+		size_type		count(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+
+			return i != size() && !_key_comp(k, _keys[i]);
+		}
+
+		const_iterator	lower_bound(const key_type& k) const { return make_iterator(lower_index(k)); }
+		const_iterator	upper_bound(const key_type& k) const { return make_iterator(upper_index(k)); }
+
+		ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+		{
+			size_type i = lower_index(k);
+			size_type j = (i != size() && !_key_comp(k, _keys[i])) ? i + 1 : i;
+
+			return ft::make_pair(make_iterator(i), make_iterator(j));
+		}
+
+		/* allocator */
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		const_iterator	make_iterator(size_type i) const
+		{ return const_iterator(_keys.begin().base() + i, _mapped.begin().base() + i); }
+
+		// the first block whose last key is not before k (lower) or after
+		// k (upper). The index is a perfect tree, so every descent takes the
+		// same number of steps and ends past the leaves at 2^h + the number
+		// of blocks that were passed, which is the block it was looking for
+		template <bool Upper>
+		size_type	descend(const key_type& k) const
+		{
+			const key_type*	index = _index.begin().base();
+			size_type		n = _index.size();
+			size_type		i = 1;
+
+			while (i < n)
+			{
+# ifdef __GNUC__
+				__builtin_prefetch(index + i * prefetch_stride);
+# endif
+				i = 2 * i + (Upper ? !_key_comp(k, index[i]) : _key_comp(index[i], k));
+			}
+			return i - n;
+		}
+
+		size_type	lower_index(const key_type& k) const
+		{
+			size_type b = descend<false>(k);
+
+			if (b * block_size >= size())
+				return size();
+			return b * block_size + block_type::lower(_keys.begin().base() + b * block_size, k, _key_comp);
+		}
+
+		size_type	upper_index(const key_type& k) const
+		{
+			size_type b = descend<true>(k);
+
+			if (b * block_size >= size())
+				return size();
+			return b * block_size + block_type::upper(_keys.begin().base() + b * block_size, k, _key_comp);
+		}
+
+		// missing nodes of the perfect tree hold the last key too, they come
+		// after the last block in key order and are never picked over it
+		void	build()
+		{
+			size_type	blocks = (size() + block_size - 1) / block_size;
+			size_type	nodes = 1;
+			size_type	b = 0;
+
+			if (empty())
+				return ;
+			key_type	last = _keys.back();
+
+			while (_keys.size() % block_size)
+				_keys.push_back(last);
+			while (nodes <= blocks)
+				nodes *= 2;
+			_index.assign(nodes, last);
+			fill(1, b, blocks);
+		}
+
+		// in-order walk of the index hands out the blocks in key order
+		void	fill(size_type i, size_type& b, size_type blocks)
+		{
+			if (i >= _index.size())
+				return ;
+			fill(2 * i, b, blocks);
+			if (b < blocks)
+				_index[i] = _keys[b * block_size + block_size - 1];
+			++b;
+			fill(2 * i + 1, b, blocks);
+		}
+	};
+
+	/* relational operators */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator==(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator!=(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<=(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>=(const frozen_map<Key, T, Compare, Alloc>& lhs, const frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	void swap(frozen_map<Key, T, Compare, Alloc>& lhs, frozen_map<Key, T, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
@@ -2,6 +2,8 @@
 # define ITERATOR_HPP
 
 # include <cstddef>
+# include <algorithm>
+# include "utils.hpp"
 
 namespace ft
 {
@@ -232,9 +234,10 @@ namespace ft
 		tree_iterator	operator--(int) { tree_iterator tmp(*this); --(*this); return tmp; }
 	
 	private:
+		// the sentinel is end(): it caches the maximum in its right link
 		node_pointer get_next_node(node_pointer node)
 		{
-			if (!node->parent)
+			if (node->is_sentinel)
 				return node;
 			if (node->right)
 			{
@@ -250,19 +253,15 @@ namespace ft
 					tmp = node;
 					node = node->parent;
 				}
-				while (node && node->left != tmp);
+				while (!node->is_sentinel && node->left != tmp);
 			}
 			return node;
 		}
 
 		node_pointer get_prev_node(node_pointer node)
 		{
-			if (!node->parent)
-			{
-				while (node->right)
-					node = node->right;
-				return node;
-			}
+			if (node->is_sentinel)
+				return node->right ? node->right : node;
 			if (node->left)
 			{
 				node = node->left;
@@ -277,7 +276,7 @@ namespace ft
 					tmp = node;
 					node = node->parent;
 				}
-				while (node && node->right != tmp);
+				while (!node->is_sentinel && node->right != tmp);
 			}
 			return node;
 		}
@@ -287,6 +286,436 @@ namespace ft
 		friend bool operator!=(const tree_iterator& lhs, const tree_iterator& rhs)
 		{ return lhs._ptr != rhs._ptr; }
 	};
+
+	/* btree_iterator */
+	// =bidirectional iterator over the linked leaves of ft::btree, end() is
+	// one past the last value of the last leaf
+	template <typename T, typename LeafType>
+	class btree_iterator
+	{
+	public:
+		typedef T								value_type;
+		typedef T*								pointer;
+		typedef T&								reference;
+		typedef ptrdiff_t						difference_type;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+
+		typedef LeafType						leaf_type;
+		typedef LeafType*						leaf_pointer;
+
+	private:
+		leaf_pointer	_leaf;
+		std::size_t		_pos;
+
+	public:
+		btree_iterator() : _leaf(NULL), _pos(0) {}
+		btree_iterator(leaf_pointer leaf, std::size_t pos) : _leaf(leaf), _pos(pos) {}
+		~btree_iterator() {}
+		btree_iterator(const btree_iterator& other) : _leaf(other._leaf), _pos(other._pos) {}
+
+		btree_iterator &operator=(const btree_iterator &rhs)
+		{
+			_leaf = rhs._leaf;
+			_pos = rhs._pos;
+			return *this;
+		}
+
+		operator btree_iterator<const value_type, leaf_type>() const
+		{ return btree_iterator<const value_type, leaf_type>(_leaf, _pos); }
+
+		leaf_pointer	leaf() const { return _leaf; }
+		std::size_t		position() const { return _pos; }
+
+		reference		operator*() const { return _leaf->values.data()[_pos]; }
+		pointer			operator->() const { return &(this->operator*()); }
+
+		btree_iterator&	operator++()
+		{
+			if (++_pos == _leaf->count && _leaf->next)
+			{
+				_leaf = _leaf->next;
+				_pos = 0;
+			}
+			return *this;
+		}
+		btree_iterator	operator++(int) { btree_iterator tmp(*this); ++(*this); return tmp; }
+
+		btree_iterator&	operator--()
+		{
+			if (_pos == 0)
+			{
+				_leaf = _leaf->prev;
+				_pos = _leaf->count;
+			}
+			--_pos;
+			return *this;
+		}
+		btree_iterator	operator--(int) { btree_iterator tmp(*this); --(*this); return tmp; }
+
+		friend bool operator==(const btree_iterator& lhs, const btree_iterator& rhs)
+		{ return lhs._leaf == rhs._leaf && lhs._pos == rhs._pos; }
+		friend bool operator!=(const btree_iterator& lhs, const btree_iterator& rhs)
+		{ return !(lhs == rhs); }
+	};
+
+
+	/* flat_map_iterator */
+	// ft::flat_map keeps keys and mapped values in two arrays, so there is no
+	// pair to point to: * yields a pair of references and -> a proxy holding
+	// one. Mapped is T or const T
+	template <typename Key, typename T, typename Mapped>
+	struct flat_map_arrow;
+
+	template <typename Key, typename T, typename Mapped>
+	struct flat_map_reference
+	{
+		const Key&	first;
+		Mapped&		second;
+
+		flat_map_reference(const Key& k, Mapped& m) : first(k), second(m) {}
+		flat_map_reference(const flat_map_reference& other) : first(other.first), second(other.second) {}
+
+		operator ft::pair<const Key, T>() const { return ft::pair<const Key, T>(first, second); }
+
+		// reverse_iterator::operator-> takes the address of operator*()
+		flat_map_arrow<Key, T, Mapped>	operator&() const { return flat_map_arrow<Key, T, Mapped>(*this); }
+
+		friend bool operator==(const flat_map_reference& lhs, const flat_map_reference& rhs)
+		{ return lhs.first == rhs.first && lhs.second == rhs.second; }
+		friend bool operator<(const flat_map_reference& lhs, const flat_map_reference& rhs)
+		{ return lhs.first < rhs.first || (!(rhs.first < lhs.first) && lhs.second < rhs.second); }
+
+	private:
+		flat_map_reference& operator=(const flat_map_reference&);
+	};
+
+	template <typename Key, typename T, typename Mapped>
+	struct flat_map_arrow
+	{
+		flat_map_reference<Key, T, Mapped>	ref;
+
+		explicit flat_map_arrow(const flat_map_reference<Key, T, Mapped>& r) : ref(r) {}
+
+		// &ref would call the overload above
+		const flat_map_reference<Key, T, Mapped>*	operator->() const
+		{ return reinterpret_cast<const flat_map_reference<Key, T, Mapped>*>(&reinterpret_cast<const char&>(ref)); }
+	};
+
+	// =random access iterator
+	template <typename Key, typename T, typename Mapped>
+	class flat_map_iterator
+	{
+	public:
+		typedef ft::pair<const Key, T>				value_type;
+		typedef flat_map_arrow<Key, T, Mapped>		pointer;
+		typedef flat_map_reference<Key, T, Mapped>	reference;
+		typedef ptrdiff_t							difference_type;
+		typedef std::random_access_iterator_tag		iterator_category;
+
+	private:
+		const Key*	_key;
+		Mapped*		_mapped;
+
+	public:
+		flat_map_iterator() : _key(NULL), _mapped(NULL) {}
+		flat_map_iterator(const Key* key, Mapped* mapped) : _key(key), _mapped(mapped) {}
+		~flat_map_iterator() {}
+		flat_map_iterator(const flat_map_iterator& other) : _key(other._key), _mapped(other._mapped) {}
+
+		flat_map_iterator &operator=(const flat_map_iterator &rhs)
+		{
+			_key = rhs._key;
+			_mapped = rhs._mapped;
+			return *this;
+		}
+
+		operator flat_map_iterator<Key, T, const T>() const
+		{ return flat_map_iterator<Key, T, const T>(_key, _mapped); }
+
+		const Key*	base(void) const { return _key; }
+		Mapped*		mapped(void) const { return _mapped; }
+
+		reference			operator*() const { return reference(*_key, *_mapped); }
+		pointer				operator->() const { return pointer(operator*()); }
+		reference			operator[](difference_type n) const { return reference(_key[n], _mapped[n]); }
+		flat_map_iterator&	operator++() { ++_key; ++_mapped; return *this; }
+		flat_map_iterator	operator++(int) { flat_map_iterator tmp(*this); ++(*this); return tmp; }
+		flat_map_iterator&	operator--() { --_key; --_mapped; return *this; }
+		flat_map_iterator	operator--(int) { flat_map_iterator tmp(*this); --(*this); return tmp; }
+		flat_map_iterator	operator+(difference_type n) const { return flat_map_iterator(_key + n, _mapped + n); }
+		flat_map_iterator&	operator+=(difference_type n) { _key += n; _mapped += n; return *this; }
+		flat_map_iterator	operator-(difference_type n) const { return flat_map_iterator(_key - n, _mapped - n); }
+		flat_map_iterator&	operator-=(difference_type n) { _key -= n; _mapped -= n; return *this; }
+	};
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator==(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() == rhs.base(); }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator!=(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() != rhs.base(); }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator<(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() < rhs.base(); }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator<=(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() <= rhs.base(); }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator>(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() > rhs.base(); }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	bool operator>=(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() >= rhs.base(); }
+
+	template <class Key, class T, class Mapped>
+	flat_map_iterator<Key, T, Mapped> operator+(typename flat_map_iterator<Key, T, Mapped>::difference_type n, const flat_map_iterator<Key, T, Mapped>& rhs)
+	{ return rhs + n; }
+
+	template <class Key, class T, class MappedL, class MappedR>
+	typename flat_map_iterator<Key, T, MappedL>::difference_type operator-(const flat_map_iterator<Key, T, MappedL>& lhs, const flat_map_iterator<Key, T, MappedR>& rhs)
+	{ return lhs.base() - rhs.base(); }
+
+
+	/* compact_tree_iterator */
+	// =bidirectional iterator over ft::compact_tree. The nodes live in a
+	// vector that moves when it grows, so the iterator holds the vector and
+	// an index into it; index 0 is the header, which is end()
+	template <typename T, typename NodeVector>
+	class compact_tree_iterator
+	{
+	public:
+		typedef T								value_type;
+		typedef T*								pointer;
+		typedef T&								reference;
+		typedef ptrdiff_t						difference_type;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+
+		typedef NodeVector						node_vector;
+		typedef typename NodeVector::value_type	node_type;
+		typedef typename node_type::index_type	index_type;
+
+	private:
+		node_vector*	_nodes;
+		index_type		_index;
+
+	public:
+		compact_tree_iterator() : _nodes(NULL), _index(0) {}
+		compact_tree_iterator(node_vector* nodes, index_type index) : _nodes(nodes), _index(index) {}
+		~compact_tree_iterator() {}
+		compact_tree_iterator(const compact_tree_iterator& other) : _nodes(other._nodes), _index(other._index) {}
+
+		compact_tree_iterator &operator=(const compact_tree_iterator &rhs)
+		{
+			_nodes = rhs._nodes;
+			_index = rhs._index;
+			return *this;
+		}
+
+		operator compact_tree_iterator<const value_type, node_vector>() const
+		{ return compact_tree_iterator<const value_type, node_vector>(_nodes, _index); }
+
+		index_type		index() const { return _index; }
+
+		reference		operator*() const { return (*_nodes)[_index].value(); }
+		pointer			operator->() const { return &(this->operator*()); }
+
+		compact_tree_iterator&	operator++()
+		{
+			const node_type*	n = _nodes->begin().base();
+			index_type			p;
+
+			if (n[_index].right)
+			{
+				for (_index = n[_index].right; n[_index].left; _index = n[_index].left) {}
+				return *this;
+			}
+			for (p = n[_index].parent(); p && _index == n[p].right; p = n[p].parent())
+				_index = p;
+			_index = p;
+			return *this;
+		}
+		compact_tree_iterator	operator++(int) { compact_tree_iterator tmp(*this); ++(*this); return tmp; }
+
+		// the header keeps the rightmost node as its right link
+		compact_tree_iterator&	operator--()
+		{
+			const node_type*	n = _nodes->begin().base();
+			index_type			p;
+
+			if (_index == 0)
+			{
+				_index = n[0].right;
+				return *this;
+			}
+			if (n[_index].left)
+			{
+				for (_index = n[_index].left; n[_index].right; _index = n[_index].right) {}
+				return *this;
+			}
+			for (p = n[_index].parent(); p && _index == n[p].left; p = n[p].parent())
+				_index = p;
+			_index = p;
+			return *this;
+		}
+		compact_tree_iterator	operator--(int) { compact_tree_iterator tmp(*this); --(*this); return tmp; }
+
+		friend bool operator==(const compact_tree_iterator& lhs, const compact_tree_iterator& rhs)
+		{ return lhs._index == rhs._index; }
+		friend bool operator!=(const compact_tree_iterator& lhs, const compact_tree_iterator& rhs)
+		{ return lhs._index != rhs._index; }
+	};
+
+
+	/* skiplist_iterator */
+	// =forward iterator over the bottom level of ft::concurrent_map, which
+	// skips the nodes erased under it. NULL is end()
+	template <typename T, typename NodeType>
+	class skiplist_iterator
+	{
+	public:
+		typedef T							value_type;
+		typedef T*							pointer;
+		typedef T&							reference;
+		typedef ptrdiff_t					difference_type;
+		typedef std::forward_iterator_tag	iterator_category;
+
+		typedef NodeType					node_type;
+		typedef NodeType*					node_pointer;
+
+	private:
+		node_pointer	_node;
+
+	public:
+		skiplist_iterator() : _node(NULL) {}
+		skiplist_iterator(node_pointer node) : _node(node) {}
+		~skiplist_iterator() {}
+		skiplist_iterator(const skiplist_iterator& other) : _node(other._node) {}
+
+		skiplist_iterator &operator=(const skiplist_iterator &rhs)
+		{
+			_node = rhs._node;
+			return *this;
+		}
+
+		operator skiplist_iterator<const value_type, node_type>() const
+		{ return skiplist_iterator<const value_type, node_type>(_node); }
+
+		node_pointer	base() const { return _node; }
+
+		reference			operator*() const { return _node->value(); }
+		pointer				operator->() const { return &(this->operator*()); }
+		skiplist_iterator&	operator++() { _node = _node->forward(); return *this; }
+		skiplist_iterator	operator++(int) { skiplist_iterator tmp(*this); ++(*this); return tmp; }
+
+		friend bool operator==(const skiplist_iterator& lhs, const skiplist_iterator& rhs)
+		{ return lhs._node == rhs._node; }
+		friend bool operator!=(const skiplist_iterator& lhs, const skiplist_iterator& rhs)
+		{ return lhs._node != rhs._node; }
+	};
+
+	/* persistent_tree_iterator */
+	// =bidirectional iterator over ft::persistent_map. Nodes are shared
+	// between versions and have no parent link, so the iterator carries
+	// its path from the root; an empty path is end(). That path is only
+	// good until the version it came from is updated
+	template <typename T, typename NodeType>
+	class persistent_tree_iterator
+	{
+	public:
+		typedef T								value_type;
+		typedef T*								pointer;
+		typedef T&								reference;
+		typedef ptrdiff_t						difference_type;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+
+		typedef NodeType						node_type;
+		typedef NodeType*						node_pointer;
+
+		// an AVL tree this high holds more nodes than fit in memory
+		static const int	max_depth = 64;
+
+	private:
+		node_pointer	_root;
+		node_pointer	_path[max_depth];
+		int				_depth;
+
+	public:
+		persistent_tree_iterator() : _root(NULL), _depth(0) {}
+		persistent_tree_iterator(node_pointer root) : _root(root), _depth(0) {}
+		~persistent_tree_iterator() {}
+		persistent_tree_iterator(const persistent_tree_iterator& other) : _root(other._root), _depth(other._depth)
+		{ std::copy(other._path, other._path + _depth, _path); }
+
+		persistent_tree_iterator &operator=(const persistent_tree_iterator &rhs)
+		{
+			_root = rhs._root;
+			_depth = rhs._depth;
+			std::copy(rhs._path, rhs._path + _depth, _path);
+			return *this;
+		}
+
+		node_pointer	base() const { return _depth ? _path[_depth - 1] : NULL; }
+
+		// the tree builds the path on the way down
+		void			push(node_pointer node) { _path[_depth++] = node; }
+		void			truncate(int depth) { _depth = depth; }
+		int				depth() const { return _depth; }
+
+		void	push_leftmost(node_pointer node)
+		{
+			for (; node; node = node->left)
+				push(node);
+		}
+
+		reference					operator*() const { return _path[_depth - 1]->value; }
+		pointer						operator->() const { return &(this->operator*()); }
+
+		persistent_tree_iterator&	operator++()
+		{
+			node_pointer child = _path[_depth - 1];
+
+			if (child->right)
+				push_leftmost(child->right);
+			else
+			{
+				for (child = _path[--_depth]; _depth && _path[_depth - 1]->right == child; )
+					child = _path[--_depth];
+			}
+			return *this;
+		}
+
+		persistent_tree_iterator	operator++(int) { persistent_tree_iterator tmp(*this); ++(*this); return tmp; }
+
+		persistent_tree_iterator&	operator--()
+		{
+			node_pointer child;
+
+			if (_depth == 0 || _path[_depth - 1]->left)
+			{
+				child = _depth ? _path[_depth - 1]->left : _root;
+				for (; child; child = child->right)
+					push(child);
+			}
+			else
+			{
+				for (child = _path[--_depth]; _depth && _path[_depth - 1]->left == child; )
+					child = _path[--_depth];
+			}
+			return *this;
+		}
+
+		persistent_tree_iterator	operator--(int) { persistent_tree_iterator tmp(*this); --(*this); return tmp; }
+
+		friend bool operator==(const persistent_tree_iterator& lhs, const persistent_tree_iterator& rhs)
+		{ return lhs.base() == rhs.base(); }
+		friend bool operator!=(const persistent_tree_iterator& lhs, const persistent_tree_iterator& rhs)
+		{ return lhs.base() != rhs.base(); }
+	};
 }
 
 #endif
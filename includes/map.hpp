@@ -5,9 +5,15 @@
 
 namespace ft
 {
-	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	class frozen_map;
+
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> >,
+		typename PoolPolicy = ft::node_pool_policy, typename NodeUpdate = ft::null_node_update>
 	class map
 	{
+		template <typename> friend struct tree_algebra;
+
 	public:
 		typedef Key										key_type;
 		typedef T										mapped_type;
@@ -30,7 +36,8 @@ namespace ft
 		typedef typename allocator_type::const_reference						const_reference;
 		typedef typename allocator_type::pointer								pointer;
 		typedef typename allocator_type::const_pointer							const_pointer;
-		typedef typename ft::tree<value_type, value_compare, allocator_type>	tree_type;
+		typedef typename ft::tree<key_type, value_type, ft::select_first<value_type>,
+			key_compare, allocator_type, PoolPolicy, NodeUpdate>				tree_type;
 		typedef typename tree_type::iterator									iterator;
 		typedef typename tree_type::const_iterator								const_iterator;
 		typedef ft::reverse_iterator<iterator>									reverse_iterator;
@@ -39,6 +46,24 @@ namespace ft
 		typedef std::size_t														size_type;
 
 	private:
+		// build the value only once the tree knows the key is missing
+		struct value_maker
+		{
+			const key_type&		key;
+			const mapped_type&	mapped;
+
+			value_maker(const key_type& k, const mapped_type& m) : key(k), mapped(m) {}
+			value_type operator()() const { return value_type(key, mapped); }
+		};
+
+		struct default_value_maker
+		{
+			const key_type&		key;
+
+			explicit default_value_maker(const key_type& k) : key(k) {}
+			value_type operator()() const { return value_type(key, mapped_type()); }
+		};
+
 		key_compare		_key_comp;
 		value_compare	_value_comp;
 		allocator_type	_alloc;
@@ -47,16 +72,21 @@ namespace ft
 	public:
 		/* constructor */
 		explicit map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
-		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(_value_comp, _alloc) {}
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(comp, alloc) {}
 
 		template <typename InputIterator>
 		map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
-      	: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(_value_comp, _alloc)
+      	: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(comp, alloc)
 		{ insert(first, last); }
 
 		map(const map& other)
 		: _key_comp(other._key_comp), _value_comp(other._value_comp), _alloc(other._alloc), _tree(other._tree) {}
 
+#if __cplusplus >= 201103L
+		map(map&& other)
+		: _key_comp(other._key_comp), _value_comp(other._value_comp), _alloc(other._alloc), _tree(std::move(other._tree)) {}
+#endif
+
 		/* destructor */
 		~map() {}
 
@@ -68,6 +98,14 @@ namespace ft
 			return *this;
 		}
 
+#if __cplusplus >= 201103L
+		map& operator=(map&& m)
+		{
+			_tree = std::move(m._tree);
+			return *this;
+		}
+#endif
+
 		/* iterators */
 		iterator				begin() { return _tree.begin(); }
 		const_iterator			begin() const { return (_tree.begin()); }
@@ -84,76 +122,197 @@ namespace ft
 		size_type	max_size() const { return _tree.max_size(); }
 	
 		/* element access */
-		mapped_type& operator[] (const key_type& k)
-		{
-			ft::pair<iterator, bool> p = insert(ft::make_pair(k, mapped_type()));
-			return p.first->second;
-		}
+		mapped_type& operator[] (const key_type& k) { return try_emplace(k).first->second; }
 
 		/* modifiers */
 		ft::pair<iterator, bool>	insert(const value_type& val) { return _tree.insert(val); }
 		iterator					insert(iterator position, const value_type& val) { return _tree.insert(position, val); }
 		template <typename InputIterator>
 		void						insert(InputIterator first, InputIterator last) { _tree.insert(first, last); }
+#if __cplusplus >= 201103L
+		ft::pair<iterator, bool>	insert(value_type&& val) { return _tree.insert(std::move(val)); }
+		template <typename... Args>
+		ft::pair<iterator, bool>	emplace(Args&&... args) { return _tree.emplace(std::forward<Args>(args)...); }
+#endif
+
+		ft::pair<iterator, bool>	try_emplace(const key_type& k) { return _tree.try_emplace(k, default_value_maker(k)); }
+		ft::pair<iterator, bool>	try_emplace(const key_type& k, const mapped_type& obj) { return _tree.try_emplace(k, value_maker(k, obj)); }
+
+		ft::pair<iterator, bool>	insert_or_assign(const key_type& k, const mapped_type& obj)
+		{
+			ft::pair<iterator, bool> p = try_emplace(k, obj);
+			if (!p.second)
+				assign(p.first, obj);
+			return p;
+		}
 
 		void		erase(iterator position) { _tree.erase(position); }
 		size_type	erase(const key_type& k) { return _tree.erase(find(k)); }
 		void		erase(iterator first, iterator last) { _tree.erase(first, last); }
 
+		// erases the keys in [lo, hi), returns how many went
+		size_type	erase_range(const key_type& lo, const key_type& hi)
+		{
+			if (!_key_comp(lo, hi))
+				return 0;
+			return _tree.erase(lower_bound(lo), lower_bound(hi));
+		}
+
 		void	swap(map& x) { _tree.swap(x._tree); }
 		void	clear() { _tree.clear(); }
 
+		// moves the keys not less than k into upper, replacing its content,
+		// without reallocating a node
+		void	split_at(const key_type& k, map& upper) { _tree.split(k, upper._tree); }
+
+		// moves over every node of other whose key is not here yet, the
+		// others stay in other
+		void	merge(map& other) { _tree.merge(other._tree); }
+
 		/* observers */
 		key_compare		key_comp() const { return _key_comp; }
 		value_compare	value_comp() const { return _value_comp; }
 
 		/* operations */
-		iterator		find(const key_type& k) { return _tree.find(ft::make_pair(k, mapped_type())); }
-		const_iterator	find(const key_type& k) const { return _tree.find(ft::make_pair(k, mapped_type())); }
+		iterator		find(const key_type& k) { return _tree.find(k); }
+		const_iterator	find(const key_type& k) const { return _tree.find(k); }
 
-		size_type		count (const key_type& k) const { return _tree.count(ft::make_pair(k, mapped_type())); }
+		size_type		count(const key_type& k) const { return _tree.count(k); }
 		
-		iterator		lower_bound (const key_type& k) { return _tree.lower_bound(ft::make_pair(k, mapped_type())); }
-		const_iterator	lower_bound (const key_type& k) const { return _tree.lower_bound(ft::make_pair(k, mapped_type())); }
+		iterator		lower_bound(const key_type& k) { return _tree.lower_bound(k); }
+		const_iterator	lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
 		
-		iterator		upper_bound (const key_type& k) { return iterator(_tree.upper_bound(ft::make_pair(k, mapped_type()))); }
-		const_iterator	upper_bound (const key_type& k) const { return (_tree.upper_bound(ft::make_pair(k, mapped_type()))); }
+		iterator		upper_bound(const key_type& k) { return _tree.upper_bound(k); }
+		const_iterator	upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
 		
-		ft::pair<iterator, iterator> equal_range (const key_type& k) { return _tree.equal_range(ft::make_pair(k, mapped_type())); }
-		ft::pair<const_iterator, const_iterator> equal_range (const key_type& k) const { return _tree.equal_range(ft::make_pair(k, mapped_type())); }
+		ft::pair<iterator, iterator> equal_range(const key_type& k) { return _tree.equal_range(k); }
+		ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* finger search */
+		// starts from hint instead of the root. Any iterator of this map is
+		// a valid hint
+		iterator		find(const_iterator hint, const key_type& k) { return _tree.find(hint, k); }
+		const_iterator	find(const_iterator hint, const key_type& k) const { return _tree.find(hint, k); }
+
+		iterator		lower_bound(const_iterator hint, const key_type& k) { return _tree.lower_bound(hint, k); }
+		const_iterator	lower_bound(const_iterator hint, const key_type& k) const { return _tree.lower_bound(hint, k); }
+
+		/* batched lookups */
+		// out[i] is find(keys[i]) or lower_bound(keys[i]). The descents of a
+		// batch go down together so their cache misses overlap, a sorted
+		// batch walks on from the previous answer instead
+		void	find_many(const key_type* keys, size_type n, iterator* out) { _tree.find_many(keys, n, out); }
+		void	find_many(const key_type* keys, size_type n, const_iterator* out) const { _tree.find_many(keys, n, out); }
+
+		void	lower_bound_many(const key_type* keys, size_type n, iterator* out) { _tree.lower_bound_many(keys, n, out); }
+		void	lower_bound_many(const key_type* keys, size_type n, const_iterator* out) const { _tree.lower_bound_many(keys, n, out); }
+
+		/* heterogeneous operations */
+		// only offered when key_compare declares is_transparent, see ft::less<>
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, iterator>::type
+		find(const K& k) { return _tree.find(k); }
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, const_iterator>::type
+		find(const K& k) const { return _tree.find(k); }
+
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, size_type>::type
+		count(const K& k) const { return _tree.count(k); }
+
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, iterator>::type
+		lower_bound(const K& k) { return _tree.lower_bound(k); }
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, const_iterator>::type
+		lower_bound(const K& k) const { return _tree.lower_bound(k); }
+
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, iterator>::type
+		upper_bound(const K& k) { return _tree.upper_bound(k); }
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, const_iterator>::type
+		upper_bound(const K& k) const { return _tree.upper_bound(k); }
+
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, ft::pair<iterator, iterator> >::type
+		equal_range(const K& k) { return _tree.equal_range(k); }
+		template <typename K>
+		typename ft::enable_if<ft::is_transparent<key_compare, K>::value, ft::pair<const_iterator, const_iterator> >::type
+		equal_range(const K& k) const { return _tree.equal_range(k); }
+
+		/* order statistics */
+		// only usable with ft::order_statistics_node_update as NodeUpdate,
+		// other maps do not pay for the subtree sizes
+		iterator		nth(size_type n) { return _tree.find_by_order(n); }
+		const_iterator	nth(size_type n) const { return _tree.find_by_order(n); }
+
+		size_type		rank(const key_type& k) const { return _tree.order_of_key(k); }
+
+		// number of keys in [lo, hi)
+		size_type		count_range(const key_type& lo, const key_type& hi) const
+		{
+			if (!_key_comp(lo, hi))
+				return 0;
+			return _tree.order_of_key(hi) - _tree.order_of_key(lo);
+		}
+
+		difference_type	distance(const_iterator first, const_iterator last) const
+		{ return static_cast<difference_type>(_tree.order_of(last)) - static_cast<difference_type>(_tree.order_of(first)); }
+
+		/* aggregates */
+		// only usable with ft::aggregate_node_update as NodeUpdate: the
+		// summary of the values with keys in [lo, hi), in O(log n)
+		typename NodeUpdate::metadata_type	aggregate(const key_type& lo, const key_type& hi) const
+		{ return _tree.aggregate(lo, hi); }
+
+		// mapped values written through an iterator or operator[] leave the
+		// summaries above them stale: write them with assign(), or call
+		// refresh() after changing one in place
+		void	assign(iterator position, const mapped_type& obj)
+		{
+			position->second = obj;
+			_tree.refresh(position);
+		}
+
+		void	refresh(iterator position) { _tree.refresh(position); }
+
+		/* snapshot */
+		// a read only copy laid out for lookups, needs frozen_map.hpp
+		ft::frozen_map<Key, T, Compare, Alloc>	freeze() const { return ft::frozen_map<Key, T, Compare, Alloc>(*this); }
 
 		/* allocator */
 		allocator_type get_allocator() const { return _tree.get_allocator(); }
 	};
 
 	/* relational operators */
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator==(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator==(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
 
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator!=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator!=(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return !(lhs == rhs); }
 
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator<(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
 	
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator<=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<=(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return !(rhs < lhs); }
 	
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator>(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return rhs < lhs; }
 
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	bool operator>=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>=(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ return !(lhs < rhs); }
 
 	/* swap */
-	template <typename Key, typename T, typename Compare, typename Alloc>
-	void swap(map<Key, T, Compare, Alloc>& lhs, map<Key, T, Compare, Alloc>& rhs)
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	void swap(map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
 	{ lhs.swap(rhs); }
 }
 
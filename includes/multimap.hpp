@@ -0,0 +1,157 @@
+#ifndef MULTIMAP_HPP
+# define MULTIMAP_HPP
+
+# include "avltree.hpp"
+
+namespace ft
+{
+	// ft::map keeping equal keys, each one after the ones inserted before it
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> >,
+		typename PoolPolicy = ft::node_pool_policy, typename NodeUpdate = ft::null_node_update>
+	class multimap
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		class	value_compare
+		{
+			friend class multimap;
+		protected:
+			key_compare comp;
+			value_compare (key_compare c) : comp(c) {}
+		public:
+			bool operator() (const value_type& x, const value_type& y) const
+			{ return (comp(x.first, y.first)); }
+		};
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef typename ft::tree<key_type, value_type, ft::select_first<value_type>,
+			key_compare, allocator_type, PoolPolicy, NodeUpdate>				tree_type;
+		typedef typename tree_type::iterator									iterator;
+		typedef typename tree_type::const_iterator								const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		key_compare		_key_comp;
+		value_compare	_value_comp;
+		allocator_type	_alloc;
+		tree_type		_tree;
+
+	public:
+		/* constructor */
+		explicit multimap(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(comp, alloc) {}
+
+		template <typename InputIterator>
+		multimap(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _value_comp(comp), _alloc(alloc), _tree(comp, alloc)
+		{ insert(first, last); }
+
+		multimap(const multimap& other)
+		: _key_comp(other._key_comp), _value_comp(other._value_comp), _alloc(other._alloc), _tree(other._tree) {}
+
+		/* destructor */
+		~multimap() {}
+
+		/* assignment operator */
+		multimap& operator=(const multimap& m)
+		{
+			if (this != &m)
+				_tree = m._tree;
+			return *this;
+		}
+
+		/* iterators */
+		iterator				begin() { return _tree.begin(); }
+		const_iterator			begin() const { return _tree.begin(); }
+		iterator				end() { return _tree.end(); }
+		const_iterator			end() const { return _tree.end(); }
+		reverse_iterator		rbegin() { return reverse_iterator(end()); }
+		const_reverse_iterator	rbegin() const { return const_reverse_iterator(end()); }
+		reverse_iterator		rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator	rend() const { return const_reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _tree.empty(); }
+		size_type	size() const { return _tree.size(); }
+		size_type	max_size() const { return _tree.max_size(); }
+
+		/* modifiers */
+		iterator	insert(const value_type& val) { return _tree.insert_equal(val); }
+		iterator	insert(iterator position, const value_type& val) { return _tree.insert_equal(position, val); }
+		template <typename InputIterator>
+		void		insert(InputIterator first, InputIterator last) { _tree.insert_equal(first, last); }
+
+		void		erase(iterator position) { _tree.erase(position); }
+		size_type	erase(const key_type& k) { return _tree.erase_equal(k); }
+		void		erase(iterator first, iterator last) { _tree.erase(first, last); }
+
+		void	swap(multimap& x) { _tree.swap(x._tree); }
+		void	clear() { _tree.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _value_comp; }
+
+		/* operations */
+		// the first of the keys equal to k, count() walks only the equal run
+		iterator		find(const key_type& k) { return _tree.find_equal(k); }
+		const_iterator	find(const key_type& k) const { return _tree.find_equal(k); }
+
+		size_type		count(const key_type& k) const { return _tree.count_equal(k); }
+
+		iterator		lower_bound(const key_type& k) { return _tree.lower_bound(k); }
+		const_iterator	lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
+
+		iterator		upper_bound(const key_type& k) { return _tree.upper_bound(k); }
+		const_iterator	upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
+
+		ft::pair<iterator, iterator> equal_range(const key_type& k) { return _tree.equal_range(k); }
+		ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _tree.get_allocator(); }
+	};
+
+	/* relational operators */
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator==(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator!=(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<=(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>=(const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	void swap(multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, multimap<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
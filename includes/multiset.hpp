@@ -0,0 +1,136 @@
+#ifndef MULTISET_HPP
+# define MULTISET_HPP
+
+# include "avltree.hpp"
+
+namespace ft
+{
+	// ft::set keeping equal keys, each one after the ones inserted before it
+	template <typename Key, typename Compare = ft::less<Key>, typename Alloc = std::allocator<Key>,
+		typename PoolPolicy = ft::node_pool_policy, typename NodeUpdate = ft::null_node_update>
+	class multiset
+	{
+	public:
+		typedef Key										key_type;
+		typedef Key										value_type;
+		typedef Compare									key_compare;
+		typedef Compare									value_compare;
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef typename ft::tree<key_type, value_type, ft::identity<value_type>,
+			key_compare, allocator_type, PoolPolicy, NodeUpdate>				tree_type;
+		// keys are never modified in place
+		typedef typename tree_type::const_iterator								iterator;
+		typedef typename tree_type::const_iterator								const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		key_compare		_key_comp;
+		allocator_type	_alloc;
+		tree_type		_tree;
+
+	public:
+		/* constructor */
+		explicit multiset(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _alloc(alloc), _tree(comp, alloc) {}
+
+		template <typename InputIterator>
+		multiset(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _alloc(alloc), _tree(comp, alloc)
+		{ insert(first, last); }
+
+		multiset(const multiset& other) : _key_comp(other._key_comp), _alloc(other._alloc), _tree(other._tree) {}
+
+		/* destructor */
+		~multiset() {}
+
+		/* assignment operator */
+		multiset& operator=(const multiset& s)
+		{
+			if (this != &s)
+				_tree = s._tree;
+			return *this;
+		}
+
+		/* iterators */
+		iterator			begin() const { return _tree.begin(); }
+		iterator			end() const { return _tree.end(); }
+		reverse_iterator	rbegin() const { return reverse_iterator(end()); }
+		reverse_iterator	rend() const { return reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _tree.empty(); }
+		size_type	size() const { return _tree.size(); }
+		size_type	max_size() const { return _tree.max_size(); }
+
+		/* modifiers */
+		iterator	insert(const value_type& val) { return _tree.insert_equal(val); }
+		iterator	insert(iterator position, const value_type& val) { return _tree.insert_equal(mutable_iterator(position), val); }
+		template <typename InputIterator>
+		void		insert(InputIterator first, InputIterator last) { _tree.insert_equal(first, last); }
+
+		void		erase(iterator position) { _tree.erase(mutable_iterator(position)); }
+		size_type	erase(const key_type& k) { return _tree.erase_equal(k); }
+		void		erase(iterator first, iterator last) { _tree.erase(mutable_iterator(first), mutable_iterator(last)); }
+
+		void	swap(multiset& x) { _tree.swap(x._tree); }
+		void	clear() { _tree.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _key_comp; }
+
+		/* operations */
+		// the first of the keys equal to k, count() walks only the equal run
+		iterator	find(const key_type& k) const { return _tree.find_equal(k); }
+		size_type	count(const key_type& k) const { return _tree.count_equal(k); }
+		iterator	lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
+		iterator	upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
+		ft::pair<iterator, iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _tree.get_allocator(); }
+
+	private:
+		static typename tree_type::iterator	mutable_iterator(iterator it) { return typename tree_type::iterator(it.base()); }
+	};
+
+	/* relational operators */
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator==(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator!=(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<=(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>=(const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	void swap(multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, multiset<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
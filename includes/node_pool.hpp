@@ -0,0 +1,376 @@
+#ifndef NODE_POOL_HPP
+# define NODE_POOL_HPP
+
+# include <memory>
+# include <cstddef>
+# include <pthread.h>
+
+namespace ft
+{
+	/* node_allocator */
+	// one allocator call per node, the default std containers behaviour
+	template <typename Node, typename Alloc>
+	class node_allocator
+	{
+	public:
+		typedef Node*			pointer;
+		typedef Alloc			allocator_type;
+		typedef std::size_t		size_type;
+
+	private:
+		allocator_type	_alloc;
+
+	public:
+		explicit node_allocator(const allocator_type& alloc = allocator_type()) : _alloc(alloc) {}
+		node_allocator(const node_allocator& other) : _alloc(other._alloc) {}
+		~node_allocator() {}
+
+		pointer	allocate() { return _alloc.allocate(1); }
+		void	deallocate(pointer p) { _alloc.deallocate(p, 1); }
+		bool	exclusive() const { return false; }
+		void	release() {}
+		void	share(node_allocator&) {}
+
+		void	swap(node_allocator& x)
+		{
+			allocator_type tmp_alloc = _alloc;
+
+			_alloc = x._alloc;
+			x._alloc = tmp_alloc;
+		}
+
+	private:
+		node_allocator& operator=(const node_allocator&);
+	};
+
+
+	/* node_pool */
+	// nodes are carved from slabs that double in size up to max_slab and
+	// erased nodes go to a freelist. The slabs live in an arena that is only
+	// handed back once nobody uses it anymore, so a tree that owns its arena
+	// drops all its nodes in O(slabs). Trees that splice nodes into each
+	// other (split, merge) share one arena from then on. A shared arena is
+	// only touched under its lock, as the trees sharing it may be used from
+	// different threads; an arena with a single user is never locked.
+	template <typename Node, typename Alloc>
+	class node_pool
+	{
+	public:
+		typedef Node*			pointer;
+		typedef Alloc			allocator_type;
+		typedef std::size_t		size_type;
+
+		static const size_type	min_slab = 32;
+		static const size_type	max_slab = 8192;
+
+	private:
+		struct free_node
+		{
+			free_node*	next;
+		};
+
+		struct slab
+		{
+			slab*		next;
+			pointer		nodes;
+			size_type	count;
+		};
+
+		// an arena merged into another one forwards to it and keeps a
+		// reference on it, so the pools still pointing at it find their way.
+		// refs and forward are atomic, the rest is guarded by lock
+		struct arena
+		{
+			arena*			forward;
+			size_type		refs;
+			pthread_mutex_t	lock;
+			slab*		slabs;
+			slab*		last_slab;
+			free_node*	free;
+			free_node*	last_free;
+			pointer		cur;
+			pointer		end;
+			size_type	next_count;
+		};
+
+		typedef typename Alloc::template rebind<slab>::other	slab_allocator_type;
+		typedef typename Alloc::template rebind<arena>::other	arena_allocator_type;
+
+		allocator_type		_alloc;
+		arena*				_arena;
+
+	public:
+		explicit node_pool(const allocator_type& alloc = allocator_type()) : _alloc(alloc), _arena(NULL) {}
+
+		// a copy starts with an arena of its own
+		node_pool(const node_pool& other) : _alloc(other._alloc), _arena(NULL) {}
+
+		~node_pool() { unref(_arena); }
+
+		pointer	allocate()
+		{
+			bool	locked;
+			arena*	a = acquire(locked);
+			pointer	p;
+
+			if (a->free)
+			{
+				p = reinterpret_cast<pointer>(a->free);
+				a->free = a->free->next;
+			}
+			else
+			{
+				if (a->cur == a->end)
+					add_slab(a);
+				p = a->cur++;
+			}
+			if (locked)
+				pthread_mutex_unlock(&a->lock);
+			return p;
+		}
+
+		void	deallocate(pointer p)
+		{
+			bool		locked;
+			arena*		a = acquire(locked);
+			free_node*	node = reinterpret_cast<free_node*>(p);
+
+			if (!a->free)
+				a->last_free = node;
+			node->next = a->free;
+			a->free = node;
+			if (locked)
+				pthread_mutex_unlock(&a->lock);
+		}
+
+		// true when no other pool hands out nodes from the same slabs, so
+		// release() frees nothing but our own nodes
+		bool	exclusive() const
+		{
+			for (arena* a = _arena; a; a = forward_of(a))
+			{
+				if (refs_of(a) != 1)
+					return false;
+			}
+			return true;
+		}
+
+		// lets go of the arena, its slabs are freed with the last user
+		void	release()
+		{
+			unref(_arena);
+			_arena = NULL;
+		}
+
+		// makes x allocate from our arena, and moves the slabs of its own
+		// arena over, so nodes may freely move between the two trees
+		void	share(node_pool& x)
+		{
+			arena*	a;
+			arena*	b;
+			bool	locked_a;
+			bool	locked_b;
+
+			if (!x._arena)
+			{
+				x._arena = get();
+				ref(x._arena);
+				return ;
+			}
+			if (!_arena)
+			{
+				_arena = x.get();
+				ref(_arena);
+				return ;
+			}
+			// both roots locked, in address order, and still roots
+			for (;;)
+			{
+				a = get();
+				b = x.get();
+				if (a == b)
+					return ;
+				locked_a = lock(a < b ? a : b);
+				locked_b = lock(a < b ? b : a);
+				if (!forward_of(a) && !forward_of(b))
+					break ;
+				if (locked_b)
+					pthread_mutex_unlock(&(a < b ? b : a)->lock);
+				if (locked_a)
+					pthread_mutex_unlock(&(a < b ? a : b)->lock);
+			}
+			if (a > b)
+			{
+				bool tmp = locked_a;
+
+				locked_a = locked_b;
+				locked_b = tmp;
+			}
+			if (b->slabs)
+			{
+				b->last_slab->next = a->slabs;
+				a->slabs = b->slabs;
+				if (!a->last_slab)
+					a->last_slab = b->last_slab;
+			}
+			if (b->free)
+			{
+				b->last_free->next = a->free;
+				a->free = b->free;
+				if (!a->last_free)
+					a->last_free = b->last_free;
+			}
+			// keep the larger untouched tail, the other one waits for release
+			if (b->end - b->cur > a->end - a->cur)
+			{
+				a->cur = b->cur;
+				a->end = b->end;
+			}
+			if (b->next_count > a->next_count)
+				a->next_count = b->next_count;
+			b->slabs = NULL;
+			b->free = NULL;
+			ref(a);
+			__atomic_store_n(&b->forward, a, __ATOMIC_RELEASE);
+			ref(a);
+			x._arena = a;
+			if (locked_b)
+				pthread_mutex_unlock(&b->lock);
+			if (locked_a)
+				pthread_mutex_unlock(&a->lock);
+			unref(b);
+		}
+
+		void	swap(node_pool& x)
+		{
+			allocator_type	tmp_alloc = _alloc;
+			arena*			tmp_arena = _arena;
+
+			_alloc = x._alloc;
+			_arena = x._arena;
+
+			x._alloc = tmp_alloc;
+			x._arena = tmp_arena;
+		}
+
+	private:
+		// the arena at the end of the forward chain, created on first use
+		arena*	get()
+		{
+			arena* root;
+
+			if (_arena && !forward_of(_arena))
+				return _arena;
+			if (!_arena)
+			{
+				arena_allocator_type arena_alloc(_alloc);
+
+				_arena = arena_alloc.allocate(1);
+				_arena->forward = NULL;
+				_arena->refs = 1;
+				pthread_mutex_init(&_arena->lock, NULL);
+				_arena->slabs = NULL;
+				_arena->last_slab = NULL;
+				_arena->free = NULL;
+				_arena->last_free = NULL;
+				_arena->cur = NULL;
+				_arena->end = NULL;
+				_arena->next_count = min_slab;
+				return _arena;
+			}
+			for (root = _arena; forward_of(root); root = forward_of(root)) {}
+			ref(root);
+			unref(_arena);
+			_arena = root;
+			return root;
+		}
+
+		// the root arena, locked when other pools may use it. The root can
+		// be merged away between get() and the lock, then we go again
+		arena*	acquire(bool& locked)
+		{
+			arena* a;
+
+			for (;;)
+			{
+				a = get();
+				locked = lock(a);
+				if (!forward_of(a))
+					return a;
+				if (locked)
+					pthread_mutex_unlock(&a->lock);
+			}
+		}
+
+		// a single user means our own pool, nobody else can reach the arena
+		static bool	lock(arena* a)
+		{
+			if (refs_of(a) == 1)
+				return false;
+			pthread_mutex_lock(&a->lock);
+			return true;
+		}
+
+		static arena*		forward_of(arena* a) { return __atomic_load_n(&a->forward, __ATOMIC_ACQUIRE); }
+		static size_type	refs_of(arena* a) { return __atomic_load_n(&a->refs, __ATOMIC_ACQUIRE); }
+		static void			ref(arena* a) { __atomic_fetch_add(&a->refs, 1, __ATOMIC_RELAXED); }
+
+		void	unref(arena* a)
+		{
+			arena_allocator_type	arena_alloc(_alloc);
+			slab_allocator_type		slab_alloc(_alloc);
+			arena*					next;
+			slab*					s;
+
+			while (a && __atomic_sub_fetch(&a->refs, 1, __ATOMIC_ACQ_REL) == 0)
+			{
+				pthread_mutex_destroy(&a->lock);
+				while (a->slabs)
+				{
+					s = a->slabs;
+					a->slabs = s->next;
+					_alloc.deallocate(s->nodes, s->count);
+					slab_alloc.deallocate(s, 1);
+				}
+				next = a->forward;
+				arena_alloc.deallocate(a, 1);
+				a = next;
+			}
+		}
+
+		void	add_slab(arena* a)
+		{
+			slab_allocator_type slab_alloc(_alloc);
+			slab*				s = slab_alloc.allocate(1);
+
+			s->nodes = _alloc.allocate(a->next_count);
+			s->count = a->next_count;
+			s->next = a->slabs;
+			if (!a->slabs)
+				a->last_slab = s;
+			a->slabs = s;
+			a->cur = s->nodes;
+			a->end = s->nodes + s->count;
+			if (a->next_count < max_slab)
+				a->next_count *= 2;
+		}
+
+		node_pool& operator=(const node_pool&);
+	};
+
+
+	/* node storage policies */
+	struct node_allocator_policy
+	{
+		template <typename Node, typename Alloc>
+		struct rebind { typedef node_allocator<Node, Alloc> other; };
+	};
+
+	struct node_pool_policy
+	{
+		template <typename Node, typename Alloc>
+		struct rebind { typedef node_pool<Node, Alloc> other; };
+	};
+}
+
+#endif
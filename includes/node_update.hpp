@@ -0,0 +1,104 @@
+#ifndef NODE_UPDATE_HPP
+# define NODE_UPDATE_HPP
+
+# include <cstddef>
+# include <limits>
+# include "utils.hpp"
+
+namespace ft
+{
+	/* node update policies */
+	// a policy keeps metadata_type in every node and recomputes it from the
+	// node and its children in update(); the tree calls update() bottom-up
+	// whenever the set of nodes below a node changes. tracks_size tells the
+	// tree whether size(node) is available to count a subtree in O(1)
+
+	struct null_metadata {};
+
+	struct null_node_update
+	{
+		typedef ft::null_metadata	metadata_type;
+
+		typedef ft::false_type		tracks_size;
+
+		static const bool			null_update = true;
+
+		template <typename Node>
+		static void	update(Node*) {}
+	};
+
+	// subtree sizes, for rank and select in O(log n)
+	struct order_statistics_node_update
+	{
+		typedef std::size_t			metadata_type;
+
+		typedef ft::true_type		tracks_size;
+
+		static const bool			null_update = false;
+
+		template <typename Node>
+		static std::size_t	size(const Node* node) { return node ? node->metadata : 0; }
+
+		template <typename Node>
+		static void	update(Node* node) { node->metadata = size(node->left) + size(node->right) + 1; }
+	};
+
+	// a summary of every value of the subtree, for range aggregates in
+	// O(log n). Monoid gives summary_type, identity(), an associative
+	// combine(a, b) of a left and a right summary, and lift(value), the
+	// summary of one stored value
+	template <typename Monoid>
+	struct aggregate_node_update
+	{
+		typedef Monoid							monoid_type;
+		typedef typename Monoid::summary_type	metadata_type;
+
+		typedef ft::false_type					tracks_size;
+
+		static const bool						null_update = false;
+
+		template <typename Node>
+		static metadata_type	summary(const Node* node) { return node ? node->metadata : Monoid::identity(); }
+
+		template <typename Node>
+		static void	update(Node* node)
+		{ node->metadata = Monoid::combine(Monoid::combine(summary(node->left), Monoid::lift(node->value)), summary(node->right)); }
+	};
+
+	/* monoids */
+	// over the mapped values of a map
+	template <typename T>
+	struct mapped_sum
+	{
+		typedef T	summary_type;
+
+		static T	identity() { return T(); }
+		static T	combine(const T& a, const T& b) { return a + b; }
+		template <typename Value>
+		static T	lift(const Value& value) { return value.second; }
+	};
+
+	template <typename T>
+	struct mapped_min
+	{
+		typedef T	summary_type;
+
+		static T	identity() { return std::numeric_limits<T>::max(); }
+		static T	combine(const T& a, const T& b) { return b < a ? b : a; }
+		template <typename Value>
+		static T	lift(const Value& value) { return value.second; }
+	};
+
+	template <typename T>
+	struct mapped_max
+	{
+		typedef T	summary_type;
+
+		static T	identity() { return std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min() : -std::numeric_limits<T>::max(); }
+		static T	combine(const T& a, const T& b) { return a < b ? b : a; }
+		template <typename Value>
+		static T	lift(const Value& value) { return value.second; }
+	};
+}
+
+#endif
@@ -0,0 +1,573 @@
+#ifndef PERSISTENT_MAP_HPP
+# define PERSISTENT_MAP_HPP
+
+# include <memory>
+# include <limits>
+# include <stdexcept>
+# include "utils.hpp"
+# include "iterator.hpp"
+# include "vector.hpp"
+
+namespace ft
+{
+	/* persistent node */
+	// refs counts the versions and nodes pointing here. A node with one
+	// reference is only seen by the version changing it and is changed in
+	// place, a shared one is copied first
+	template <typename T>
+	struct persistent_node
+	{
+		typedef T					value_type;
+		typedef persistent_node*	node_pointer;
+
+		node_pointer	left;
+		node_pointer	right;
+		std::size_t		refs;
+		int				height;
+		value_type		value;
+
+		persistent_node(const value_type& v) : left(NULL), right(NULL), refs(1), height(0), value(v) {}
+	};
+
+
+	/* persistent map */
+	// an AVL map whose copies share every subtree they have in common.
+	// Copying or snapshot() is O(1), an update copies the O(log n) nodes on
+	// its path that are still shared and leaves the other versions as they
+	// were. A version frees the nodes only it held when it goes away.
+	//
+	// Nodes have no parent link, a node may sit under many parents, so the
+	// balancing is the one of avltree.hpp done on the way back up a
+	// recursive descent. Each link is passed by reference and owns its
+	// reference on the node, an exception at any point leaves a valid tree.
+	//
+	// Versions can be handed to other threads: the nodes they share are
+	// never written and the counts are atomic. A single version is not
+	// safe to update and read at once, take the snapshot on the writer side
+	//
+	// Iterators hold the path from the root, and an update rewrites or
+	// frees the nodes this version owns alone: any insert, erase or
+	// insert_or_assign invalidates every iterator of this version. To walk
+	// a map while changing it, iterate a snapshot()
+	template <typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class persistent_map
+	{
+	public:
+		typedef Key										key_type;
+		typedef T										mapped_type;
+		typedef ft::pair<const key_type, mapped_type>	value_type;
+		typedef Compare									key_compare;
+
+		class	value_compare
+		{
+			friend class persistent_map;
+		protected:
+			key_compare comp;
+			value_compare (key_compare c) : comp(c) {}
+		public:
+			bool operator() (const value_type& x, const value_type& y) const
+			{ return (comp(x.first, y.first)); }
+		};
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef ft::persistent_node<value_type>									node_type;
+		typedef typename node_type::node_pointer								node_pointer;
+		// values are shared between versions, they are never modified in place
+		typedef ft::persistent_tree_iterator<const value_type, node_type>		iterator;
+		typedef ft::persistent_tree_iterator<const value_type, node_type>		const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		typedef typename Alloc::template rebind<node_type>::other	node_allocator_type;
+
+		key_compare				_comp;
+		node_allocator_type		_alloc;
+		node_pointer			_root;
+		size_type				_size;
+
+	public:
+		/* constructor */
+		explicit persistent_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _comp(comp), _alloc(alloc), _root(NULL), _size(0) {}
+
+		template <typename InputIterator>
+		persistent_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _comp(comp), _alloc(alloc), _root(NULL), _size(0)
+		{
+			try
+			{
+				insert(first, last);
+			}
+			catch (...)
+			{
+				release(_root);
+				throw;
+			}
+		}
+
+		persistent_map(const persistent_map& other)
+		: _comp(other._comp), _alloc(other._alloc), _root(retain(other._root)), _size(other._size) {}
+
+		/* destructor */
+		~persistent_map() { release(_root); }
+
+		/* assignment operator */
+		persistent_map& operator=(const persistent_map& m)
+		{
+			node_pointer old = _root;
+
+			_comp = m._comp;
+			_alloc = m._alloc;
+			_root = retain(m._root);
+			_size = m._size;
+			release(old);
+			return *this;
+		}
+
+		// the current version, frozen: later updates of this map do not show in it
+		persistent_map	snapshot() const { return *this; }
+
+		/* iterators */
+		iterator		begin() const
+		{
+			iterator it(_root);
+
+			it.push_leftmost(_root);
+			return it;
+		}
+
+		iterator		end() const { return iterator(_root); }
+
+		reverse_iterator	rbegin() const { return reverse_iterator(end()); }
+		reverse_iterator	rend() const { return reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _size == 0; }
+		size_type	size() const { return _size; }
+		size_type	max_size() const
+		{ return std::min<size_type>(_alloc.max_size(), std::numeric_limits<difference_type>::max()); }
+
+		/* element access */
+		const mapped_type&	at(const key_type& k) const
+		{
+			node_pointer node = find_node(k);
+
+			if (!node)
+				throw (std::out_of_range("persistent_map::at"));
+			return node->value.second;
+		}
+
+		/* modifiers */
+		ft::pair<iterator, bool>	insert(const value_type& val)
+		{
+			if (!find_node(val.first))
+			{
+				insert_node(_root, val);
+				++_size;
+				return ft::make_pair(find(val.first), true);
+			}
+			return ft::make_pair(find(val.first), false);
+		}
+
+		iterator	insert(iterator hint, const value_type& val)
+		{
+			(void)hint;
+			return insert(val).first;
+		}
+
+		template <typename InputIterator>
+		void		insert(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		ft::pair<iterator, bool>	insert_or_assign(const key_type& k, const mapped_type& obj)
+		{
+			if (find_node(k))
+			{
+				assign_node(_root, k, obj);
+				return ft::make_pair(find(k), false);
+			}
+			return insert(ft::make_pair(k, obj));
+		}
+
+		void		erase(iterator position) { erase(position->first); }
+
+		size_type	erase(const key_type& k)
+		{
+			if (!find_node(k))
+				return 0;
+			erase_node(_root, k);
+			return 1;
+		}
+
+		void		erase(iterator first, iterator last)
+		{
+			ft::vector<key_type> keys;
+
+			for (; first != last; ++first)
+				keys.push_back(first->first);
+			for (size_type i = 0; i < keys.size(); ++i)
+				erase(keys[i]);
+		}
+
+		void	swap(persistent_map& x)
+		{
+			std::swap(_comp, x._comp);
+			std::swap(_alloc, x._alloc);
+			std::swap(_root, x._root);
+			std::swap(_size, x._size);
+		}
+
+		void	clear()
+		{
+			release(_root);
+			_root = NULL;
+			_size = 0;
+		}
+
+		/* observers */
+		key_compare		key_comp() const { return _comp; }
+		value_compare	value_comp() const { return value_compare(_comp); }
+
+		/* operations */
+		iterator	find(const key_type& k) const
+		{
+			iterator		it(_root);
+			node_pointer	node = _root;
+
+			while (node)
+			{
+				it.push(node);
+				if (_comp(k, key(node)))
+					node = node->left;
+				else if (_comp(key(node), k))
+					node = node->right;
+				else
+					return it;
+			}
+			return end();
+		}
+
+		size_type	count(const key_type& k) const { return find_node(k) != NULL; }
+
+		iterator	lower_bound(const key_type& k) const { return bound(k, false); }
+		iterator	upper_bound(const key_type& k) const { return bound(k, true); }
+
+		ft::pair<iterator, iterator>	equal_range(const key_type& k) const
+		{ return ft::make_pair(lower_bound(k), upper_bound(k)); }
+
+		/* allocator */
+		allocator_type	get_allocator() const { return allocator_type(_alloc); }
+
+	private:
+		static const key_type&	key(node_pointer node) { return node->value.first; }
+
+		node_pointer	find_node(const key_type& k) const
+		{
+			node_pointer node = _root;
+
+			while (node)
+			{
+				if (_comp(k, key(node)))
+					node = node->left;
+				else if (_comp(key(node), k))
+					node = node->right;
+				else
+					return node;
+			}
+			return NULL;
+		}
+
+		// the path is cut back to the last node the search went left at
+		iterator		bound(const key_type& k, bool upper) const
+		{
+			iterator		it(_root);
+			node_pointer	node = _root;
+			int				depth = 0;
+
+			while (node)
+			{
+				it.push(node);
+				if (upper ? _comp(k, key(node)) : !_comp(key(node), k))
+				{
+					depth = it.depth();
+					node = node->left;
+				}
+				else
+					node = node->right;
+			}
+			it.truncate(depth);
+			return it;
+		}
+
+		/* nodes */
+		node_pointer	create_node(const value_type& val)
+		{
+			node_pointer node = _alloc.allocate(1);
+
+			try
+			{
+				_alloc.construct(node, node_type(val));
+			}
+			catch (...)
+			{
+				_alloc.deallocate(node, 1);
+				throw;
+			}
+			return node;
+		}
+
+		static node_pointer	retain(node_pointer node)
+		{
+			if (node)
+				__atomic_fetch_add(&node->refs, 1, __ATOMIC_RELAXED);
+			return node;
+		}
+
+		// drops one reference, the last one frees the node and drops its
+		// children's. Goes down the left spine in a loop
+		void	release(node_pointer node)
+		{
+			node_pointer left;
+
+			while (node && __atomic_fetch_sub(&node->refs, 1, __ATOMIC_ACQ_REL) == 1)
+			{
+				left = node->left;
+				release(node->right);
+				_alloc.destroy(node);
+				_alloc.deallocate(node, 1);
+				node = left;
+			}
+		}
+
+		// makes link point to a node only this version sees, copying the
+		// one it points to if it is shared
+		void	make_writable(node_pointer& link)
+		{
+			node_pointer copy;
+
+			if (__atomic_load_n(&link->refs, __ATOMIC_ACQUIRE) == 1)
+				return ;
+			copy = create_node(link->value);
+			copy->left = retain(link->left);
+			copy->right = retain(link->right);
+			copy->height = link->height;
+			release(link);
+			link = copy;
+		}
+
+		/* avl */
+		static int	get_height(node_pointer node) { return node ? node->height : -1; }
+
+		static void	update_height(node_pointer node)
+		{
+			int left = get_height(node->left);
+			int right = get_height(node->right);
+
+			node->height = (left > right ? left : right) + 1;
+		}
+
+		static int	balance_factor(node_pointer node)
+		{ return get_height(node->left) - get_height(node->right); }
+
+		// link is writable
+		void	rotate_ll(node_pointer& link)
+		{
+			node_pointer node = link;
+			node_pointer left;
+
+			make_writable(node->left);
+			left = node->left;
+			node->left = left->right;
+			left->right = node;
+			update_height(node);
+			update_height(left);
+			link = left;
+		}
+
+		void	rotate_rr(node_pointer& link)
+		{
+			node_pointer node = link;
+			node_pointer right;
+
+			make_writable(node->right);
+			right = node->right;
+			node->right = right->left;
+			right->left = node;
+			update_height(node);
+			update_height(right);
+			link = right;
+		}
+
+		void	rebalance(node_pointer& link)
+		{
+			node_pointer	node = link;
+			int				factor;
+
+			update_height(node);
+			factor = balance_factor(node);
+			if (factor > 1)
+			{
+				if (balance_factor(node->left) < 0)
+				{
+					make_writable(node->left);
+					rotate_rr(node->left);
+				}
+				rotate_ll(link);
+			}
+			else if (factor < -1)
+			{
+				if (balance_factor(node->right) > 0)
+				{
+					make_writable(node->right);
+					rotate_ll(node->right);
+				}
+				rotate_rr(link);
+			}
+		}
+
+		// the key of val is not in the tree yet
+		void	insert_node(node_pointer& link, const value_type& val)
+		{
+			if (!link)
+			{
+				link = create_node(val);
+				return ;
+			}
+			make_writable(link);
+			if (_comp(val.first, key(link)))
+				insert_node(link->left, val);
+			else
+				insert_node(link->right, val);
+			rebalance(link);
+		}
+
+		// k is in the tree
+		void	assign_node(node_pointer& link, const key_type& k, const mapped_type& obj)
+		{
+			make_writable(link);
+			if (_comp(k, key(link)))
+				assign_node(link->left, k, obj);
+			else if (_comp(key(link), k))
+				assign_node(link->right, k, obj);
+			else
+				link->value.second = obj;
+		}
+
+		// k is in the tree. The size drops as soon as the node is out, a
+		// copy made by the rebalancing above may still throw
+		void	erase_node(node_pointer& link, const key_type& k)
+		{
+			node_pointer min = NULL;
+
+			make_writable(link);
+			if (_comp(k, key(link)))
+				erase_node(link->left, k);
+			else if (_comp(key(link), k))
+				erase_node(link->right, k);
+			else if (!link->left || !link->right)
+			{
+				// the child moves up as it is, it may be shared
+				replace_node(link, link->left ? link->left : link->right);
+				return ;
+			}
+			else
+			{
+				// once the successor is out it takes the place of the node
+				// even if the rebalancing under it throws
+				try
+				{
+					take_min(link->right, min);
+				}
+				catch (...)
+				{
+					if (min)
+					{
+						replace_node(link, min);
+						update_height(link);
+					}
+					throw;
+				}
+				replace_node(link, min);
+			}
+			rebalance(link);
+		}
+
+		// the node at link leaves the tree and node comes in its place:
+		// either one of its children moving up as it is, or a detached
+		// node taking both children over
+		void	replace_node(node_pointer& link, node_pointer node)
+		{
+			node_pointer old = link;
+
+			if (node != old->left && node != old->right)
+			{
+				node->left = old->left;
+				node->right = old->right;
+			}
+			old->left = NULL;
+			old->right = NULL;
+			link = node;
+			release(old);
+			--_size;
+		}
+
+		// unlinks the smallest node under link into min, writable. min is
+		// the caller's, so the node is not lost if a rebalancing on the way
+		// back up throws
+		void	take_min(node_pointer& link, node_pointer& min)
+		{
+			make_writable(link);
+			if (!link->left)
+			{
+				min = link;
+				link = min->right;
+				min->right = NULL;
+				return ;
+			}
+			take_min(link->left, min);
+			rebalance(link);
+		}
+	};
+
+	/* relational operators */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator==(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator!=(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator<=(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator>=(const persistent_map<Key, T, Compare, Alloc>& lhs, const persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	void swap(persistent_map<Key, T, Compare, Alloc>& lhs, persistent_map<Key, T, Compare, Alloc>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
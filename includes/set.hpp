@@ -0,0 +1,135 @@
+#ifndef SET_HPP
+# define SET_HPP
+
+# include "avltree.hpp"
+
+namespace ft
+{
+	// the tree of ft::map holding bare keys, no pair and no mapped value
+	template <typename Key, typename Compare = ft::less<Key>, typename Alloc = std::allocator<Key>,
+		typename PoolPolicy = ft::node_pool_policy, typename NodeUpdate = ft::null_node_update>
+	class set
+	{
+	public:
+		typedef Key										key_type;
+		typedef Key										value_type;
+		typedef Compare									key_compare;
+		typedef Compare									value_compare;
+
+		typedef Alloc															allocator_type;
+		typedef typename allocator_type::reference								reference;
+		typedef typename allocator_type::const_reference						const_reference;
+		typedef typename allocator_type::pointer								pointer;
+		typedef typename allocator_type::const_pointer							const_pointer;
+		typedef typename ft::tree<key_type, value_type, ft::identity<value_type>,
+			key_compare, allocator_type, PoolPolicy, NodeUpdate>				tree_type;
+		// keys are never modified in place
+		typedef typename tree_type::const_iterator								iterator;
+		typedef typename tree_type::const_iterator								const_iterator;
+		typedef ft::reverse_iterator<iterator>									reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef std::ptrdiff_t													difference_type;
+		typedef std::size_t														size_type;
+
+	private:
+		key_compare		_key_comp;
+		allocator_type	_alloc;
+		tree_type		_tree;
+
+	public:
+		/* constructor */
+		explicit set(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _alloc(alloc), _tree(comp, alloc) {}
+
+		template <typename InputIterator>
+		set(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _key_comp(comp), _alloc(alloc), _tree(comp, alloc)
+		{ insert(first, last); }
+
+		set(const set& other) : _key_comp(other._key_comp), _alloc(other._alloc), _tree(other._tree) {}
+
+		/* destructor */
+		~set() {}
+
+		/* assignment operator */
+		set& operator=(const set& s)
+		{
+			if (this != &s)
+				_tree = s._tree;
+			return *this;
+		}
+
+		/* iterators */
+		iterator			begin() const { return _tree.begin(); }
+		iterator			end() const { return _tree.end(); }
+		reverse_iterator	rbegin() const { return reverse_iterator(end()); }
+		reverse_iterator	rend() const { return reverse_iterator(begin()); }
+
+		/* capacity */
+		bool		empty() const { return _tree.empty(); }
+		size_type	size() const { return _tree.size(); }
+		size_type	max_size() const { return _tree.max_size(); }
+
+		/* modifiers */
+		ft::pair<iterator, bool>	insert(const value_type& val) { return _tree.insert(val); }
+		iterator					insert(iterator position, const value_type& val) { return _tree.insert(mutable_iterator(position), val); }
+		template <typename InputIterator>
+		void						insert(InputIterator first, InputIterator last) { _tree.insert(first, last); }
+
+		void		erase(iterator position) { _tree.erase(mutable_iterator(position)); }
+		size_type	erase(const key_type& k) { return _tree.erase(_tree.find(k)); }
+		void		erase(iterator first, iterator last) { _tree.erase(mutable_iterator(first), mutable_iterator(last)); }
+
+		void	swap(set& x) { _tree.swap(x._tree); }
+		void	clear() { _tree.clear(); }
+
+		/* observers */
+		key_compare		key_comp() const { return _key_comp; }
+		value_compare	value_comp() const { return _key_comp; }
+
+		/* operations */
+		iterator	find(const key_type& k) const { return _tree.find(k); }
+		size_type	count(const key_type& k) const { return _tree.count(k); }
+		iterator	lower_bound(const key_type& k) const { return _tree.lower_bound(k); }
+		iterator	upper_bound(const key_type& k) const { return _tree.upper_bound(k); }
+		ft::pair<iterator, iterator> equal_range(const key_type& k) const { return _tree.equal_range(k); }
+
+		/* allocator */
+		allocator_type get_allocator() const { return _tree.get_allocator(); }
+
+	private:
+		static typename tree_type::iterator	mutable_iterator(iterator it) { return typename tree_type::iterator(it.base()); }
+	};
+
+	/* relational operators */
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator==(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator!=(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs == rhs); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator<=(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(rhs < lhs); }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return rhs < lhs; }
+
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	bool operator>=(const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, const set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ return !(lhs < rhs); }
+
+	/* swap */
+	template <typename Key, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	void swap(set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& lhs, set<Key, Compare, Alloc, PoolPolicy, NodeUpdate>& rhs)
+	{ lhs.swap(rhs); }
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef SET_ALGEBRA_HPP
+# define SET_ALGEBRA_HPP
+
+# include <pthread.h>
+# include <unistd.h>
+# include "map.hpp"
+
+namespace ft
+{
+	enum set_operation
+	{
+		set_union,
+		set_intersection,
+		set_difference
+	};
+
+	/* tree algebra */
+	// divide and conquer over the nodes of one tree, the other one is only
+	// searched: the root key cuts the range of the other tree in two, both
+	// halves are solved apart and joined back over the root. Subproblems
+	// above the cutoff go to a new thread until every thread has one, the
+	// rest is a merge appended in order to a fragment tree, so no element
+	// is ever looked up again in the result
+	template <typename Tree>
+	struct tree_algebra
+	{
+		typedef typename Tree::key_type			key_type;
+		typedef typename Tree::value_type		value_type;
+		typedef typename Tree::key_of_value		key_of_value;
+		typedef typename Tree::key_compare		key_compare;
+		typedef typename Tree::allocator_type	allocator_type;
+		typedef typename Tree::node_pointer		node_pointer;
+		typedef typename Tree::const_iterator	const_iterator;
+
+		// an avl subtree this high holds at least a few hundred nodes
+		static const int	min_fork_height = 12;
+		// steps through the searched tree before jumping with a lookup
+		static const int	max_gallop = 8;
+
+		struct task
+		{
+			const Tree*		searched;
+			node_pointer	node;
+			const_iterator	first;
+			const_iterator	last;
+			set_operation	op;
+			bool			swapped;
+			int				depth;
+			// set by a worker thread the task threw in
+			bool			failed;
+			Tree			out;
+
+			task(const Tree* searched, node_pointer node, const_iterator first, const_iterator last,
+				set_operation op, bool swapped, int depth, const key_compare& comp, const allocator_type& alloc)
+			: searched(searched), node(node), first(first), last(last), op(op), swapped(swapped), depth(depth),
+				failed(false), out(comp, alloc) {}
+		};
+
+		// joins the worker however solve() is left, the task it writes to
+		// lives on the stack being unwound
+		struct join_guard
+		{
+			pthread_t	thread;
+			bool		forked;
+
+			join_guard(pthread_t thread, bool forked) : thread(thread), forked(forked) {}
+			~join_guard()
+			{
+				if (forked)
+					pthread_join(thread, NULL);
+			}
+		};
+
+		// a union walks the larger tree and an intersection the smaller
+		// one; swapped tells which side the value of a shared key comes from
+		static void	run(const Tree& a, const Tree& b, set_operation op, unsigned threads, Tree& out)
+		{
+			bool		swapped = false;
+			int			depth = 0;
+
+			if (op == set_union)
+				swapped = b._size > a._size;
+			else if (op == set_intersection)
+				swapped = b._size < a._size;
+			while ((1u << depth) < threads)
+				++depth;
+
+			const Tree&	walked = swapped ? b : a;
+			const Tree&	searched = swapped ? a : b;
+			task		t(&searched, walked._root, searched.begin(), searched.end(),
+							op, swapped, depth, a.key_comp(), a.get_allocator());
+
+			solve(t);
+			out.swap(t.out);
+		}
+
+		template <typename Map>
+		static Map	apply(const Map& a, const Map& b, set_operation op, unsigned threads)
+		{
+			Map		res(a.key_comp(), a.get_allocator());
+			long	cpus;
+
+			if (threads == 0)
+			{
+				cpus = sysconf(_SC_NPROCESSORS_ONLN);
+				threads = cpus > 0 ? static_cast<unsigned>(cpus) : 1;
+			}
+			run(a._tree, b._tree, op, threads, res._tree);
+			return res;
+		}
+
+	private:
+		static const key_type&	key(const value_type& val) { return key_of_value()(val); }
+
+		// an exception cannot leave the thread, it is only recorded
+		static void*	start(void* arg)
+		{
+			task& t = *static_cast<task*>(arg);
+
+			try
+			{
+				solve(t);
+			}
+			catch (...)
+			{
+				t.failed = true;
+			}
+			return NULL;
+		}
+
+		static void	solve(task& t)
+		{
+			if (t.depth == 0 || !t.node || t.node->height < min_fork_height)
+			{
+				merge(t);
+				return ;
+			}
+
+			key_compare		comp = t.out.key_comp();
+			const key_type&	k = key(t.node->value);
+			const_iterator	mid = t.searched->lower_bound(k);
+			bool			found = mid != t.last && !comp(k, key(*mid));
+			const_iterator	next = mid;
+			pthread_t		thread;
+			bool			forked;
+
+			if (found)
+				++next;
+			task	left(t.searched, t.node->left, t.first, mid, t.op, t.swapped, t.depth - 1, comp, t.out.get_allocator());
+			task	right(t.searched, t.node->right, next, t.last, t.op, t.swapped, t.depth - 1, comp, t.out.get_allocator());
+
+			forked = pthread_create(&thread, NULL, &tree_algebra::start, &left) == 0;
+			{
+				join_guard	guard(thread, forked);
+
+				solve(right);
+			}
+			// a failed side is done again here, serially, and its exception
+			// is thrown in this thread if it comes back
+			if (left.failed)
+			{
+				left.out.clear();
+				left.depth = 0;
+			}
+			if (!forked || left.failed)
+				solve(left);
+			if (t.op == set_union || (t.op == set_intersection) == found)
+				left.out.join(found && t.swapped ? *mid : t.node->value, right.out);
+			else
+				left.out.join(right.out);
+			t.out.swap(left.out);
+		}
+
+		// the in-order nodes of t.node against [first, last), the searched
+		// side is skipped with a lookup when it lags behind for too long
+		static void	merge(task& t)
+		{
+			key_compare		comp = t.out.key_comp();
+			const_iterator	it;
+			const_iterator	end;
+			const_iterator	b = t.first;
+			int				steps = 0;
+
+			if (t.node)
+			{
+				node_pointer node = t.node;
+
+				while (node->left)
+					node = node->left;
+				it = const_iterator(node);
+				for (node = t.node; node->right; node = node->right) {}
+				end = ++const_iterator(node);
+			}
+			while (it != end && b != t.last)
+			{
+				if (comp(key(*it), key(*b)))
+				{
+					if (t.op != set_intersection)
+						append(t, *it);
+					++it;
+					steps = 0;
+				}
+				else if (comp(key(*b), key(*it)))
+				{
+					if (t.op == set_union)
+						append(t, *b);
+					if (t.op == set_union || ++steps < max_gallop)
+						++b;
+					else
+					{
+						b = t.searched->lower_bound(key(*it));
+						steps = 0;
+					}
+				}
+				else
+				{
+					if (t.op != set_difference)
+						append(t, t.swapped ? *b : *it);
+					++it;
+					++b;
+				}
+			}
+			for (; it != end && t.op != set_intersection; ++it)
+				append(t, *it);
+			for (; b != t.last && t.op == set_union; ++b)
+				append(t, *b);
+		}
+
+		static void	append(task& t, const value_type& val) { t.out.insert(t.out.end(), val); }
+	};
+
+
+	/* set algebra */
+	// the result holds its own copy of every element, a key found in both
+	// maps keeps the value of a. threads = 0 uses every online cpu
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>
+	map_union(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& a,
+		const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& b, unsigned threads = 0)
+	{ return ft::tree_algebra<typename map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>::tree_type>::apply(a, b, ft::set_union, threads); }
+
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>
+	map_intersection(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& a,
+		const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& b, unsigned threads = 0)
+	{ return ft::tree_algebra<typename map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>::tree_type>::apply(a, b, ft::set_intersection, threads); }
+
+	// the keys of a that are not in b
+	template <typename Key, typename T, typename Compare, typename Alloc, typename PoolPolicy, typename NodeUpdate>
+	map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>
+	map_difference(const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& a,
+		const map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>& b, unsigned threads = 0)
+	{ return ft::tree_algebra<typename map<Key, T, Compare, Alloc, PoolPolicy, NodeUpdate>::tree_type>::apply(a, b, ft::set_difference, threads); }
+}
+
+#endif
@@ -20,6 +20,10 @@ namespace ft
 		/* constructor */
 		explicit stack(const container_type& ctnr = container_type()) : _c(ctnr) {}
 		stack(const stack& other) : _c(other._c) {}
+#if __cplusplus >= 201103L
+		explicit stack(container_type&& ctnr) : _c(std::move(ctnr)) {}
+		stack(stack&& other) : _c(std::move(other._c)) {}
+#endif
 
 		/* destructor */
 		~stack(void) {}
@@ -30,6 +34,14 @@ namespace ft
 			_c = rhs._c;
 			return *this;
 		}
+
+#if __cplusplus >= 201103L
+		stack& operator=(stack&& rhs)
+		{
+			_c = std::move(rhs._c);
+			return *this;
+		}
+#endif
 		
 		/* member functions */
 		bool				empty() const { return _c.empty(); }
@@ -38,6 +50,11 @@ namespace ft
 		const value_type&	top() const { return _c.back(); }
 		void				push (const value_type& val) { _c.push_back(val); }
 		void				pop() { _c.pop_back(); }
+#if __cplusplus >= 201103L
+		void				push(value_type&& val) { _c.push_back(std::move(val)); }
+		template <typename... Args>
+		void				emplace(Args&&... args) { _c.emplace_back(std::forward<Args>(args)...); }
+#endif
 
 		/* relational operators */
 		friend bool operator==(const stack& lhs, const stack& rhs)
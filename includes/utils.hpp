@@ -1,6 +1,12 @@
 #ifndef UTILS_HPP
 # define UTILS_HPP
 
+# include <cstddef>
+# if __cplusplus >= 201103L
+#  include <utility>
+#  include <type_traits>
+# endif
+
 namespace ft
 {
 	/* enable_if */
@@ -39,6 +45,77 @@ namespace ft
 	template<>	struct is_integral<unsigned long> : public true_type {};
 
 
+	/* is_trivially_destructible */
+# if defined(__has_builtin)
+#  if __has_builtin(__is_trivially_destructible)
+#   define FT_TRIVIALLY_DESTRUCTIBLE(T) __is_trivially_destructible(T)
+#  endif
+# endif
+# if !defined(FT_TRIVIALLY_DESTRUCTIBLE) && (defined(__GNUC__) || defined(__clang__))
+#  define FT_TRIVIALLY_DESTRUCTIBLE(T) __has_trivial_destructor(T)
+# endif
+
+# if defined(FT_TRIVIALLY_DESTRUCTIBLE)
+	template <typename T>
+	struct is_trivially_destructible
+	{ static const bool value = FT_TRIVIALLY_DESTRUCTIBLE(T); };
+# else
+	// without compiler support only the integral types are known to be safe
+	template <typename T>
+	struct is_trivially_destructible
+	{ static const bool value = is_integral<T>::value; };
+# endif
+
+
+	/* is_trivially_copyable */
+	// copies of these are plain byte copies, a memcpy or memmove can stand in
+	// for the copy constructor, the assignment and the destructor
+# if defined(__has_builtin)
+#  if __has_builtin(__is_trivially_copyable)
+#   define FT_TRIVIALLY_COPYABLE(T) __is_trivially_copyable(T)
+#  endif
+# endif
+# if !defined(FT_TRIVIALLY_COPYABLE) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#  define FT_TRIVIALLY_COPYABLE(T) __is_trivially_copyable(T)
+# endif
+# if !defined(FT_TRIVIALLY_COPYABLE) && defined(__GNUC__)
+#  define FT_TRIVIALLY_COPYABLE(T) (__has_trivial_copy(T) && __has_trivial_assign(T) && __has_trivial_destructor(T))
+# endif
+
+# if defined(FT_TRIVIALLY_COPYABLE)
+	template <typename T>
+	struct is_trivially_copyable
+	{ static const bool value = FT_TRIVIALLY_COPYABLE(T); };
+# else
+	template <typename T>
+	struct is_trivially_copyable
+	{ static const bool value = is_integral<T>::value; };
+# endif
+
+
+	/* is_trivially_copy_constructible */
+	// only the copy constructor is a byte copy. Unlike is_trivially_copyable
+	// this holds for pair<const Key, T>, which cannot be assigned
+# if defined(__has_builtin)
+#  if __has_builtin(__is_trivially_constructible)
+#   define FT_TRIVIALLY_COPY_CONSTRUCTIBLE(T) __is_trivially_constructible(T, const T&)
+#  endif
+# endif
+# if !defined(FT_TRIVIALLY_COPY_CONSTRUCTIBLE) && (defined(__GNUC__) || defined(__clang__))
+#  define FT_TRIVIALLY_COPY_CONSTRUCTIBLE(T) __has_trivial_copy(T)
+# endif
+
+# if defined(FT_TRIVIALLY_COPY_CONSTRUCTIBLE)
+	template <typename T>
+	struct is_trivially_copy_constructible
+	{ static const bool value = FT_TRIVIALLY_COPY_CONSTRUCTIBLE(T); };
+# else
+	template <typename T>
+	struct is_trivially_copy_constructible
+	{ static const bool value = is_integral<T>::value; };
+# endif
+
+
 	/* equal */
 	template <typename InputIterator1, typename InputIterator2>
 	bool equal (InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
@@ -97,6 +174,76 @@ namespace ft
 	}
 
 
+	/* branchless search */
+	// binary search over a sorted array where the only data dependent step
+	// is a conditional move, so it never mispredicts. Both possible next
+	// probes are prefetched while the current one is compared
+	template <typename T, typename K, typename Compare>
+	const T*	branchless_lower_bound(const T* first, std::size_t n, const K& k, Compare comp)
+	{
+		const T*	base = first;
+		std::size_t	half;
+
+		if (n == 0)
+			return first;
+		while (n > 1)
+		{
+			half = n / 2;
+# ifdef __GNUC__
+			__builtin_prefetch(base + half / 2);
+			__builtin_prefetch(base + half + half / 2);
+# endif
+			base = comp(base[half], k) ? base + half : base;
+			n -= half;
+		}
+		return base + comp(*base, k);
+	}
+
+	template <typename T, typename K, typename Compare>
+	const T*	branchless_upper_bound(const T* first, std::size_t n, const K& k, Compare comp)
+	{
+		const T*	base = first;
+		std::size_t	half;
+
+		if (n == 0)
+			return first;
+		while (n > 1)
+		{
+			half = n / 2;
+# ifdef __GNUC__
+			__builtin_prefetch(base + half / 2);
+			__builtin_prefetch(base + half + half / 2);
+# endif
+			base = comp(k, base[half]) ? base : base + half;
+			n -= half;
+		}
+		return base + !comp(k, *base);
+	}
+
+
+	/* aligned_storage */
+	// raw room for one T, aligned like T and no more, so a small value
+	// does not pad the node it sits in
+	template <typename T>
+	struct aligned_storage
+	{
+# ifdef __GNUC__
+		unsigned char	bytes[sizeof(T)] __attribute__((aligned(__alignof__(T))));
+# else
+		union
+		{
+			unsigned char	bytes[sizeof(T)];
+			long double		align_ld;
+			double			align_d;
+			void*			align_ptr;
+		};
+# endif
+
+		T*			data() { return reinterpret_cast<T*>(bytes); }
+		const T*	data() const { return reinterpret_cast<const T*>(bytes); }
+	};
+
+
 	/* pair */
 	template <typename T1, typename T2>
 	struct pair
@@ -112,15 +259,21 @@ namespace ft
 		template<typename U, typename V>
 		pair(const pair<U,V>& pr) : first(pr.first), second(pr.second) {}
 
-		pair& operator=(const pair& pr)
-		{
-			if (this != &pr)
-			{
-				first = pr.first;
-				second = pr.second;
-			}
-			return *this;
-		}
+		// copies and assignment stay implicit, so a pair of trivially
+		// copyable types is trivially copyable too
+#if __cplusplus >= 201103L
+		pair(const pair&) = default;
+		pair(pair&&) = default;
+		pair& operator=(const pair&) = default;
+		pair& operator=(pair&&) = default;
+		// only for arguments the members are constructible from, so that
+		// pair(NULL, 0) still finds the const reference constructor
+		template <typename U, typename V, typename = typename ft::enable_if<
+			std::is_constructible<first_type, U&&>::value && std::is_constructible<second_type, V&&>::value>::type>
+		pair(U&& a, V&& b) : first(std::forward<U>(a)), second(std::forward<V>(b)) {}
+		template <typename U, typename V>
+		pair(pair<U,V>&& pr) : first(std::forward<U>(pr.first)), second(std::forward<V>(pr.second)) {}
+#endif
 	};
 
 	template <typename T1, typename T2>
@@ -151,11 +304,17 @@ namespace ft
 	/* make_pair */
 	template <typename T1, typename T2>
 	pair<T1, T2> make_pair(T1 x, T2 y)
-	{ return (pair<T1, T2>(x, y)); }
+	{
+#if __cplusplus >= 201103L
+		return (pair<T1, T2>(std::move(x), std::move(y)));
+#else
+		return (pair<T1, T2>(x, y));
+#endif
+	}
 
 
 	/* less */
-	template <typename T>
+	template <typename T = void>
 	struct less
 	{
 		bool operator()(const T &lhs, const T &rhs) const
@@ -163,6 +322,46 @@ namespace ft
 			return lhs < rhs;
 		}
 	};
+
+	// transparent version: compares mixed types, so map<std::string, T, less<> >
+	// can be searched with a const char* without building a std::string
+	template <>
+	struct less<void>
+	{
+		typedef void	is_transparent;
+
+		template <typename T, typename U>
+		bool operator()(const T &lhs, const U &rhs) const
+		{
+			return lhs < rhs;
+		}
+	};
+
+
+	/* is_transparent */
+	template <typename T>
+	struct void_type { typedef void type; };
+
+	// K only makes the test depend on a member template parameter
+	template <typename Compare, typename K, typename = void>
+	struct is_transparent : public false_type {};
+
+	template <typename Compare, typename K>
+	struct is_transparent<Compare, K, typename void_type<typename Compare::is_transparent>::type> : public true_type {};
+
+
+	/* key extraction */
+	template <typename T>
+	struct identity
+	{
+		const T& operator()(const T& x) const { return x; }
+	};
+
+	template <typename Pair>
+	struct select_first
+	{
+		const typename Pair::first_type& operator()(const Pair& p) const { return p.first; }
+	};
 }
 
 #endif
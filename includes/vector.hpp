@@ -2,6 +2,7 @@
 # define VECTOR_HPP
 
 # include <memory>
+# include <cstring>
 # include <limits>
 # include <algorithm>
 # include <stdexcept>
@@ -55,20 +56,30 @@ namespace ft
 			_size = n;
 			_capacity = n;
 			_ptr = _alloc.allocate(n);
-			for (size_type i = 0; i < n; i++)
-				_alloc.construct(_ptr + i, *(first++));
+			construct_range(_ptr, first, n);
 		}
 
 		vector(const vector& other)
 		: _alloc(other._alloc), _ptr(NULL)
 		{
-			_ptr = _alloc.allocate(other._capacity);
+			// sized to the elements only, like the range constructor
+			_ptr = _alloc.allocate(other._size);
 			_size = other._size;
-			_capacity = other._capacity;
-			for (size_type i = 0; i < _size; i++)
-				_alloc.construct(_ptr + i, other._ptr[i]);
+			_capacity = other._size;
+			construct_copy(_ptr, other._ptr, _size);
 		}
 
+#if __cplusplus >= 201103L
+		// takes the buffer, other is left empty
+		vector(vector&& other) noexcept
+		: _alloc(other._alloc), _ptr(other._ptr), _size(other._size), _capacity(other._capacity)
+		{
+			other._ptr = NULL;
+			other._size = 0;
+			other._capacity = 0;
+		}
+#endif
+
 		/* destructor */
 		~vector()
 		{
@@ -85,6 +96,18 @@ namespace ft
 			return *this;
 		}
 
+#if __cplusplus >= 201103L
+		vector& operator=(vector&& v) noexcept
+		{
+			if (this != &v)
+			{
+				vector tmp(std::move(v));
+				swap(tmp);
+			}
+			return *this;
+		}
+#endif
+
 		/* iterators */
 		iterator 				begin() { return iterator(_ptr); }
 		const_iterator			begin() const { return const_iterator(_ptr); }
@@ -111,10 +134,7 @@ namespace ft
 					_alloc.construct(_ptr + i, val);
 			}
 			else
-			{
-				for (size_type i = n; i < _size; i++)
-					_alloc.destroy(_ptr + i);
-			}
+				destroy_range(_ptr + n, _ptr + _size);
 			_size = n;
 		}
 		
@@ -129,9 +149,17 @@ namespace ft
 			if (n > _capacity)
 			{
 				pointer new_ptr = _alloc.allocate(n);
-				for (size_type i = 0; i < _size; i++)
-					_alloc.construct(new_ptr + i, *(_ptr + i));
-				_alloc.deallocate(_ptr, _capacity);
+				try
+				{
+					relocate(new_ptr, _ptr, _size);
+				}
+				catch (...)
+				{
+					_alloc.deallocate(new_ptr, n);
+					throw;
+				}
+				if (_ptr)
+					_alloc.deallocate(_ptr, _capacity);
 				_ptr = new_ptr;
 				_capacity = n;
 			}
@@ -168,8 +196,8 @@ namespace ft
 			size_type n = std::distance(first, last);
 			if (n > _capacity)
 				reserve(n);
-			for (InputIterator it = first; it != last; it++)
-				push_back(*it);
+			construct_range(_ptr, first, n);
+			_size = n;
 		}
 
 		void	assign(size_type n, const value_type& val)
@@ -184,11 +212,25 @@ namespace ft
 		void	push_back(const value_type& val)
 		{
 			if (_size == _capacity)
-				reserve( empty() ? 1 : _capacity * 2 );
+				return grow_push_back(val);
 			_alloc.construct(_ptr + _size, val);
 			++_size;
 		}
 
+#if __cplusplus >= 201103L
+		void	push_back(value_type&& val) { emplace_back(std::move(val)); }
+
+		// builds the element in place from args
+		template <typename... Args>
+		void	emplace_back(Args&&... args)
+		{
+			if (_size == _capacity)
+				return grow_emplace_back(std::forward<Args>(args)...);
+			_alloc.construct(_ptr + _size, std::forward<Args>(args)...);
+			++_size;
+		}
+#endif
+
 		void	pop_back()
 		{
 			if (_size > 0)
@@ -196,37 +238,19 @@ namespace ft
 			--_size;
 		}
 
-		iterator	insert(iterator position, const value_type& val)
-		{
-			size_type idx = position - begin();
-			if (_size == _capacity)
-				reserve( empty() ? 1 : _capacity * 2 );
-			size_type j = _size;
-			while (j != idx)
-			{
-				--j;
-				_alloc.construct(&(*(_ptr + j + 1)), *(_ptr + j));
-			}
-  			_alloc.construct(&(*(_ptr + idx)), val);
-  			++_size;
-  			return (iterator(_ptr + idx));
-		}
-		
+		iterator	insert(iterator position, const value_type& val) { return insert(position, 1, val); }
+
 		iterator	insert(iterator position, size_type n, const value_type& val)
 		{
 			size_type idx = position - begin();
-			if (_size + n > _capacity)
-				reserve( (_size + n > _capacity * 2) ? _size + n : _capacity * 2 );
-			size_type j = _size;
-			while (j != idx)
+			if (is_inside(val))
 			{
-				--j;
-				_alloc.construct(&(*(_ptr + j + n)), *(_ptr + j));
+				value_type tmp(val);
+				return insert(position, n, tmp);
 			}
-			for (size_type i = 0; i < n; i++)
-   				_alloc.construct(&(*(_ptr + idx + i)), val);
-  			_size += n;
-  			return (iterator(_ptr + idx));
+			fill_iterator fill = {&val};
+			insert_n(idx, fill, n);
+			return (iterator(_ptr + idx));
 		}
 
 		template <typename InputIterator>
@@ -235,51 +259,35 @@ namespace ft
 		{
 			size_type idx = position - begin();
 			size_type n = std::distance(first, last);
-			if (_size + n > _capacity)
-				reserve( (_size + n > _capacity * 2) ? _size + n : _capacity * 2 );
-			size_type j = _size;
-			while (j != idx)
-			{
-				--j;
-				_alloc.construct(&(*(_ptr + j + n)), *(_ptr + j));
-			}
-			for (size_type i = n; i > 0; i--)
-				_alloc.construct(&(*(_ptr + idx + (i - 1))), *(--last));
-			_size += n;
+			insert_n(idx, first, n);
 		}
 
-		iterator erase(iterator position)
-		{
-			iterator it = begin();
-			while (it != position)
-				++it;
-			_alloc.destroy(&(*it));
-			while (it + 1 != end())
-			{
-				_alloc.construct(&(*it), *(it + 1));
-				++it;
-			}
-			pop_back();
-			return position;
-		}
+		iterator erase(iterator position) { return erase(position, position + 1); }
 
+		// the tail is shifted down over [first, last) and the vacated end
+		// destroyed in one go, nothing before first is touched
 		iterator erase(iterator first, iterator last)
 		{
-			iterator position = first;
-			size_type n = std::distance(first, last);
-			iterator it = begin();
-			while (it != first)
-				++it;
-			for (; first != last; first++)
-				_alloc.destroy(&(*first));
-			while (it + n != end())
+			pointer		dst = first.base();
+			pointer		src = last.base();
+			pointer		old_end = _ptr + _size;
+
+			if (dst == src)
+				return first;
+			if (ft::is_trivially_copyable<value_type>::value)
+				std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), (old_end - src) * sizeof(value_type));
+			else
 			{
-				_alloc.construct(&(*it), *(it + n));
-				++it;
+				for (; src != old_end; ++dst, ++src)
+#if __cplusplus >= 201103L
+					*dst = std::move(*src);
+#else
+					*dst = *src;
+#endif
+				destroy_range(dst, old_end);
 			}
-			for (size_type i = 0; i < n; i++)
-				pop_back();
-			return position;
+			_size -= last - first;
+			return first;
 		}
 
 		void swap (vector& x)
@@ -302,13 +310,283 @@ namespace ft
 
 		void clear()
 		{
-			for (iterator it = begin(); it != end(); it++)
-				_alloc.destroy(&(*it));
+			destroy_range(_ptr, _ptr + _size);
 			_size = 0;
 		}
 
 		/* allocator */
 		allocator_type	get_allocator() const { return _alloc; }
+
+	private:
+		/* element moves */
+		// trivially copyable elements are moved around with memcpy and
+		// memmove and never destroyed, the others one at a time through
+		// the allocator
+
+		// copies n elements into the raw slots at dst, on a throw the ones
+		// already built are destroyed again
+		void	construct_copy(pointer dst, const_pointer src, size_type n)
+		{
+			size_type	i = 0;
+
+			if (ft::is_trivially_copyable<value_type>::value)
+			{
+				if (n)
+					std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+				return ;
+			}
+			try
+			{
+				for (; i < n; i++)
+					_alloc.construct(dst + i, src[i]);
+			}
+			catch (...)
+			{
+				destroy_range(dst, dst + i);
+				throw;
+			}
+		}
+
+		template <typename InputIterator>
+		void	construct_range(pointer dst, InputIterator first, size_type n)
+		{
+			size_type	i = 0;
+
+			try
+			{
+				for (; i < n; i++, ++first)
+					_alloc.construct(dst + i, *first);
+			}
+			catch (...)
+			{
+				destroy_range(dst, dst + i);
+				throw;
+			}
+		}
+		void	construct_range(pointer dst, pointer first, size_type n) { construct_copy(dst, first, n); }
+		void	construct_range(pointer dst, const_pointer first, size_type n) { construct_copy(dst, first, n); }
+		void	construct_range(pointer dst, iterator first, size_type n) { construct_copy(dst, first.base(), n); }
+		void	construct_range(pointer dst, const_iterator first, size_type n) { construct_copy(dst, first.base(), n); }
+
+		// like construct_copy but moves, unless a throwing move could lose
+		// elements, src is left as it was
+		void	construct_move(pointer dst, pointer src, size_type n)
+		{
+#if __cplusplus >= 201103L
+			size_type	i = 0;
+
+			if (ft::is_trivially_copyable<value_type>::value)
+			{
+				if (n)
+					std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+				return ;
+			}
+			try
+			{
+				for (; i < n; i++)
+					_alloc.construct(dst + i, std::move_if_noexcept(src[i]));
+			}
+			catch (...)
+			{
+				destroy_range(dst, dst + i);
+				throw;
+			}
+#else
+			construct_copy(dst, src, n);
+#endif
+		}
+
+		// moves n elements to the raw slots at dst, src is left raw. the
+		// sources only go once every element is built, so a throw leaves
+		// src untouched and dst raw
+		void	relocate(pointer dst, pointer src, size_type n)
+		{
+			construct_move(dst, src, n);
+			destroy_range(src, src + n);
+		}
+
+		// capacity for n more elements, at least doubled
+		size_type	grow_capacity(size_type n) const
+		{
+			size_type	cap = (_size + n > _capacity * 2) ? _size + n : _capacity * 2;
+
+			if (cap > max_size())
+				throw (std::length_error("allocate size too big"));
+			return cap;
+		}
+
+		// val is built in the new buffer before the old one goes, so it may
+		// be one of our own elements
+		void	grow_push_back(const value_type& val)
+		{
+			size_type	n = grow_capacity(1);
+			pointer		new_ptr = _alloc.allocate(n);
+
+			try
+			{
+				_alloc.construct(new_ptr + _size, val);
+			}
+			catch (...)
+			{
+				_alloc.deallocate(new_ptr, n);
+				throw;
+			}
+			grow_commit(new_ptr, n);
+		}
+
+#if __cplusplus >= 201103L
+		// same for args, which may refer to our own elements too
+		template <typename... Args>
+		void	grow_emplace_back(Args&&... args)
+		{
+			size_type	n = grow_capacity(1);
+			pointer		new_ptr = _alloc.allocate(n);
+
+			try
+			{
+				_alloc.construct(new_ptr + _size, std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				_alloc.deallocate(new_ptr, n);
+				throw;
+			}
+			grow_commit(new_ptr, n);
+		}
+#endif
+
+		// the new last element is already built at new_ptr + _size, the
+		// others follow it over and the old buffer is released
+		void	grow_commit(pointer new_ptr, size_type n)
+		{
+			try
+			{
+				relocate(new_ptr, _ptr, _size);
+			}
+			catch (...)
+			{
+				_alloc.destroy(new_ptr + _size);
+				_alloc.deallocate(new_ptr, n);
+				throw;
+			}
+			if (_ptr)
+				_alloc.deallocate(_ptr, _capacity);
+			_ptr = new_ptr;
+			_capacity = n;
+			++_size;
+		}
+
+		// hands out the same value n times, so a fill insert takes the
+		// range path
+		struct fill_iterator
+		{
+			const value_type*	val;
+
+			const value_type&	operator*() const { return *val; }
+			fill_iterator&		operator++() { return *this; }
+		};
+
+		// inserts the n elements from first at idx. _size only ever covers
+		// built slots, so a throw leaves a valid vector, and when the
+		// buffer grows the old one is kept until everything is in place
+		template <typename ForwardIterator>
+		void	insert_n(size_type idx, ForwardIterator first, size_type n)
+		{
+			pointer		pos = _ptr + idx;
+			pointer		old_end = _ptr + _size;
+			size_type	after = _size - idx;
+
+			if (n == 0)
+				return ;
+			if (_size + n > _capacity)
+				return insert_realloc(idx, first, n);
+			if (ft::is_trivially_copyable<value_type>::value)
+			{
+				std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), after * sizeof(value_type));
+				construct_range(pos, first, n);
+				_size += n;
+				return ;
+			}
+			if (after > n)
+			{
+				// the last n go to raw slots, the rest shift over live ones
+				construct_move(old_end, old_end - n, n);
+				_size += n;
+				for (pointer src = old_end - n; src != pos; )
+				{
+					--src;
+#if __cplusplus >= 201103L
+					src[n] = std::move(*src);
+#else
+					src[n] = *src;
+#endif
+				}
+				assign_range(pos, first, n);
+			}
+			else
+			{
+				// the values past the old end are built first, then the
+				// tail moves behind them
+				ForwardIterator	mid = first;
+
+				for (size_type i = 0; i < after; i++)
+					++mid;
+				construct_range(old_end, mid, n - after);
+				_size += n - after;
+				construct_move(pos + n, pos, after);
+				_size += after;
+				assign_range(pos, first, after);
+			}
+		}
+
+		template <typename ForwardIterator>
+		void	insert_realloc(size_type idx, ForwardIterator first, size_type n)
+		{
+			size_type	cap = grow_capacity(n);
+			pointer		new_ptr = _alloc.allocate(cap);
+			int			built = 0;
+
+			try
+			{
+				construct_range(new_ptr + idx, first, n);
+				built = 1;
+				construct_move(new_ptr, _ptr, idx);
+				built = 2;
+				construct_move(new_ptr + idx + n, _ptr + idx, _size - idx);
+			}
+			catch (...)
+			{
+				if (built > 0)
+					destroy_range(new_ptr + idx, new_ptr + idx + n);
+				if (built > 1)
+					destroy_range(new_ptr, new_ptr + idx);
+				_alloc.deallocate(new_ptr, cap);
+				throw;
+			}
+			destroy_range(_ptr, _ptr + _size);
+			if (_ptr)
+				_alloc.deallocate(_ptr, _capacity);
+			_ptr = new_ptr;
+			_size += n;
+			_capacity = cap;
+		}
+
+		template <typename InputIterator>
+		void	assign_range(pointer dst, InputIterator first, size_type n)
+		{
+			for (; n > 0; --n, ++dst, ++first)
+				*dst = *first;
+		}
+
+		void	destroy_range(pointer first, pointer last)
+		{
+			if (ft::is_trivially_destructible<value_type>::value)
+				return ;
+			for (; first != last; ++first)
+				_alloc.destroy(first);
+		}
+
+		bool	is_inside(const value_type& val) const { return &val >= _ptr && &val < _ptr + _size; }
 	};	
 
 	/* relational operators */
@@ -1,10 +1,24 @@
+#include <pthread.h>
+#include <sys/time.h>
+#include <cmath>
 #include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <set>
 #include <stack>
+#include <string>
 #include <vector>
+#include "../includes/btree_map.hpp"
+#include "../includes/compact_map.hpp"
+#include "../includes/concurrent_map.hpp"
+#include "../includes/flat_map.hpp"
+#include "../includes/frozen_map.hpp"
 #include "../includes/map.hpp"
+#include "../includes/multiset.hpp"
+#include "../includes/persistent_map.hpp"
+#include "../includes/set.hpp"
+#include "../includes/set_algebra.hpp"
 #include "../includes/stack.hpp"
 #include "../includes/vector.hpp"
 
@@ -39,6 +53,398 @@ std::clock_t map_insert_growing(std::size_t times, Map map) {
 }
 
 
+/* scrambled keys so the tree sees neither sorted nor reverse sorted input */
+inline int scramble_key(std::size_t i, std::size_t times) {
+  return static_cast<int>((i * 2654435761u) % (times * 4 + 1));
+}
+
+template <class Map>
+std::clock_t map_insert_scrambled(std::size_t times, Map& map) {
+  Timer t;
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map[scramble_key(i, times)] = true;
+  }
+  return t.stop();
+}
+
+template <class Map>
+std::clock_t map_erase_scrambled(std::size_t times, Map& map) {
+  Timer t;
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map.erase(scramble_key(i, times));
+  }
+  return t.stop();
+}
+
+template <class Map>
+long map_traverse(const Map& map) {
+  long sum = 0;
+  for (typename Map::const_iterator it = map.begin() ; it != map.end() ; ++it) {
+    sum += it->first;
+  }
+  return sum;
+}
+
+template <class Map>
+void map_node_storage(const char* name, std::size_t times) {
+  Timer t;
+  std::clock_t ins;
+  std::clock_t trav;
+  std::clock_t dtor;
+  long sum;
+  Map* map = new Map;
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    (*map)[scramble_key(i, times)] = true;
+  }
+  ins = t.stop();
+  t.start();
+  sum = map_traverse(*map);
+  trav = t.stop();
+  t.start();
+  delete map;
+  dtor = t.stop();
+  std::cout << std::setw(12) << name
+            << std::setw(12) << ins
+            << std::setw(12) << trav
+            << std::setw(12) << dtor
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+template <class Map>
+void map_layout(const char* name, std::size_t times) {
+  Timer t;
+  std::clock_t ins;
+  std::clock_t look;
+  std::clock_t scan;
+  long sum = 0;
+  Map map;
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map[scramble_key(i, times)] = true;
+  }
+  ins = t.stop();
+  t.start();
+  /* half hits, half misses, in scrambled order */
+  for (std::size_t i = 0 ; i < times ; i++) {
+    sum += map.count(scramble_key(i * 7 + 3, times));
+  }
+  look = t.stop();
+  t.start();
+  sum += map_traverse(map);
+  scan = t.stop();
+  std::cout << std::setw(12) << name
+            << std::setw(12) << ins
+            << std::setw(12) << look
+            << std::setw(12) << scan
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+/* every key inserted dups times, so a multiset holds runs of equal keys */
+template <class Set>
+void set_layout(const char* name, std::size_t times, std::size_t dups) {
+  Timer t;
+  std::clock_t ins;
+  std::clock_t look;
+  std::clock_t del;
+  long sum = 0;
+  Set set;
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    set.insert(scramble_key(i / dups, times));
+  }
+  ins = t.stop();
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    sum += set.count(scramble_key(i * 7 + 3, times));
+  }
+  look = t.stop();
+  t.start();
+  for (std::size_t i = 0 ; i < times ; i += dups) {
+    sum += set.erase(scramble_key(i / dups, times));
+  }
+  del = t.stop();
+  std::cout << std::setw(14) << name
+            << std::setw(12) << ins
+            << std::setw(12) << look
+            << std::setw(12) << del
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+template <class Map, class Pair>
+void map_bulk_layout(const char* name, std::size_t times) {
+  Timer t;
+  std::clock_t build;
+  std::clock_t look;
+  std::clock_t scan;
+  long sum = 0;
+  std::vector<Pair> in;
+  for (std::size_t i = 0 ; i < times ; i++) {
+    in.push_back(Pair(scramble_key(i, times), true));
+  }
+  t.start();
+  Map map(in.begin(), in.end());
+  build = t.stop();
+  t.start();
+  /* half hits, half misses, in scrambled order */
+  for (std::size_t i = 0 ; i < times ; i++) {
+    sum += map.count(scramble_key(i * 7 + 3, times));
+  }
+  look = t.stop();
+  t.start();
+  sum += map_traverse(map);
+  scan = t.stop();
+  std::cout << std::setw(12) << name
+            << std::setw(12) << build
+            << std::setw(12) << look
+            << std::setw(12) << scan
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+template <class Map>
+std::clock_t map_erase_front(std::size_t times, Map map) {
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map[i] = true;
+  }
+  Timer t;
+  t.start();
+  /* drop the oldest half, then a few small windows */
+  map.erase(map.begin(), map.lower_bound(times / 2));
+  for (std::size_t i = times / 2 ; i + 1000 < times ; i += times / 16) {
+    map.erase(map.lower_bound(i), map.lower_bound(i + 1000));
+  }
+  return t.stop();
+}
+
+/* n keys to merge m interleaved ones into */
+template <class Map>
+void map_merge_fill(std::size_t n, std::size_t m, Map& a, Map& b) {
+  for (std::size_t i = 0 ; i < n ; i++) {
+    a[i * 2] = true;
+  }
+  for (std::size_t i = 0 ; i < m ; i++) {
+    b[(i * (n / m)) * 2 + 1] = true;
+  }
+}
+
+/* wall clock, clock() adds up the cpu time of every thread */
+double wall_ms(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/* scrambled lookups, half hits, in millions per second of wall time */
+template <class Map>
+void map_lookup_rate(const char* name, const Map& map, std::size_t times) {
+  long sum = 0;
+  double start = wall_ms();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    sum += map.count(scramble_key(i * 7 + 3, times));
+  }
+  double ms = wall_ms() - start;
+  std::cout << std::setw(12) << name
+            << std::setw(12) << ms
+            << std::setw(12) << times / ms / 1000.0
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+/* ft::map behind one mutex, the baseline for concurrent_map */
+class locked_map {
+ private:
+  ft::map<int, int> __map;
+  pthread_mutex_t __mutex;
+
+  locked_map(const locked_map& m);
+  locked_map& operator=(const locked_map& m);
+
+ public:
+  locked_map(void) { pthread_mutex_init(&__mutex, NULL); }
+  ~locked_map(void) { pthread_mutex_destroy(&__mutex); }
+
+  std::size_t count(int key) {
+    pthread_mutex_lock(&__mutex);
+    std::size_t n = __map.count(key);
+    pthread_mutex_unlock(&__mutex);
+    return n;
+  }
+  void insert(const ft::pair<const int, int>& val) {
+    pthread_mutex_lock(&__mutex);
+    __map.insert(val);
+    pthread_mutex_unlock(&__mutex);
+  }
+  void erase(int key) {
+    pthread_mutex_lock(&__mutex);
+    __map.erase(key);
+    pthread_mutex_unlock(&__mutex);
+  }
+};
+
+/* one thread of a mixed workload: reads_pct lookups, the rest half inserts half erases */
+template <class Map>
+struct map_workload {
+  Map* map;
+  std::size_t ops;
+  int keys;
+  int reads_pct;
+  unsigned int seed;
+  long hits;
+};
+
+template <class Map>
+void* map_workload_run(void* arg) {
+  map_workload<Map>* w = static_cast<map_workload<Map>*>(arg);
+  unsigned int x = w->seed;
+  for (std::size_t i = 0 ; i < w->ops ; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    int key = static_cast<int>((x >> 8) % w->keys);
+    int op = static_cast<int>(x % 100);
+    if (op < w->reads_pct) {
+      w->hits += w->map->count(key);
+    } else if (op & 1) {
+      w->map->insert(ft::make_pair(key, key));
+    } else {
+      w->map->erase(key);
+    }
+  }
+  return NULL;
+}
+
+/* the same total of operations split over the threads, in Mops/sec of wall time */
+template <class Map>
+double map_workload_rate(int threads, int reads_pct, std::size_t ops, int keys) {
+  Map map;
+  std::vector<pthread_t> ids(threads);
+  std::vector<map_workload<Map> > work(threads);
+  for (int key = 0 ; key < keys ; key += 2) {
+    map.insert(ft::make_pair(key, key));
+  }
+  double start = wall_ms();
+  for (int i = 0 ; i < threads ; i++) {
+    map_workload<Map> w = {&map, ops / threads, keys, reads_pct, 2463534242u + i * 7919u, 0};
+    work[i] = w;
+    pthread_create(&ids[i], NULL, &map_workload_run<Map>, &work[i]);
+  }
+  for (int i = 0 ; i < threads ; i++) {
+    pthread_join(ids[i], NULL);
+  }
+  return ops / (wall_ms() - start) / 1000.0;
+}
+
+/* a writer updating a map and handing a copy to readers every period updates */
+template <class Map>
+void map_snapshot_updates(const char* name, std::size_t times, std::size_t updates, std::size_t period) {
+  Map map;
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map.insert(ft::make_pair(scramble_key(i, times), static_cast<int>(i)));
+  }
+  double start = wall_ms();
+  Map snapshot(map);
+  double copy_ms = wall_ms() - start;
+  start = wall_ms();
+  for (std::size_t i = 0 ; i < updates ; i++) {
+    int key = scramble_key(i * 7 + 3, times);
+    map.erase(key);
+    map.insert(ft::make_pair(key, static_cast<int>(i)));
+    if (i % period == 0) {
+      snapshot = map;
+    }
+  }
+  std::cout << std::setw(16) << name
+            << std::setw(12) << copy_ms
+            << std::setw(12) << wall_ms() - start
+            << std::setw(12) << snapshot.size() << std::endl;
+}
+
+/* times lookups of keys in chunks of batch: one find each, or one find_many */
+template <class Map>
+void map_batch_lookup(const char* name, const Map& map, const std::vector<int>& keys, std::size_t batch) {
+  std::vector<typename Map::const_iterator> out(batch);
+  long sum = 0;
+  double start = wall_ms();
+  for (std::size_t i = 0 ; i + batch <= keys.size() ; i += batch) {
+    for (std::size_t j = 0 ; j < batch ; j++) {
+      out[j] = map.find(keys[i + j]);
+    }
+    sum += out[batch - 1] != map.end();
+  }
+  double loop_ms = wall_ms() - start;
+  start = wall_ms();
+  for (std::size_t i = 0 ; i + batch <= keys.size() ; i += batch) {
+    map.find_many(&keys[i], batch, &out[0]);
+    sum += out[batch - 1] != map.end();
+  }
+  double many_ms = wall_ms() - start;
+  std::cout << std::setw(12) << name
+            << std::setw(12) << loop_ms
+            << std::setw(12) << many_ms
+            << std::setw(11) << loop_ms / many_ms << "x"
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+/* ascending lookups gap keys apart over keys below span, wrapping around, from
+   the root and from the previous answer */
+template <class Map>
+void map_finger_walk(const Map& map, int gap, int span, std::size_t times) {
+  typename Map::const_iterator it = map.begin();
+  long sum = 0;
+  double start = wall_ms();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    sum += map.lower_bound(static_cast<int>(i * gap % span)) != map.end();
+  }
+  double root_ms = wall_ms() - start;
+  start = wall_ms();
+  for (std::size_t i = 0 ; i < times ; i++) {
+    it = map.lower_bound(it, static_cast<int>(i * gap % span));
+    sum += it != map.end();
+  }
+  double hint_ms = wall_ms() - start;
+  std::cout << std::setw(12) << gap
+            << std::setw(12) << root_ms
+            << std::setw(12) << hint_ms
+            << std::setw(11) << root_ms / hint_ms << "x"
+            << "  (" << sum % 10 << ")" << std::endl;
+}
+
+/* what set algebra looked like before: walk both maps, insert one by one */
+template <class Map>
+Map map_naive_algebra(const Map& a, const Map& b, bool intersect) {
+  Map res;
+  typename Map::const_iterator i = a.begin();
+  typename Map::const_iterator j = b.begin();
+  while (i != a.end() && j != b.end()) {
+    if (i->first < j->first) {
+      if (!intersect) res.insert(*i);
+      ++i;
+    } else if (j->first < i->first) {
+      if (!intersect) res.insert(*j);
+      ++j;
+    } else {
+      res.insert(*i);
+      ++i;
+      ++j;
+    }
+  }
+  for (; i != a.end() && !intersect ; ++i) res.insert(*i);
+  for (; j != b.end() && !intersect ; ++j) res.insert(*j);
+  return res;
+}
+
+template <class Map, class Vector>
+std::clock_t map_range_construct(const Vector& sorted) {
+  Timer t;
+  t.start();
+  /* range constructor from a sorted dump */
+  {
+    Map map(sorted.begin(), sorted.end());
+  }
+  return t.stop();
+}
+
 template <class Stack>
 std::clock_t stack_insert_growing(std::size_t times, Stack stack) {
   Timer t;
@@ -77,10 +483,58 @@ std::clock_t vector_insert_growing(std::size_t times, Vector vector) {
   return t.stop();
 }
 
+/* erase-heavy: one at a time from the back and from the front, then
+   chunks of 16 out of the first third */
+template <class Vector>
+void vector_erase_layout(const char* name, std::size_t times, const typename Vector::value_type& val) {
+  Timer t;
+  std::clock_t back;
+  std::clock_t front;
+  std::clock_t middle;
+  Vector vector(times, val);
+  t.start();
+  while (!vector.empty()) {
+    vector.erase(vector.end() - 1);
+  }
+  back = t.stop();
+  vector.assign(times, val);
+  t.start();
+  while (!vector.empty()) {
+    vector.erase(vector.begin());
+  }
+  front = t.stop();
+  vector.assign(times, val);
+  t.start();
+  while (vector.size() > 16) {
+    vector.erase(vector.begin() + vector.size() / 3, vector.begin() + vector.size() / 3 + 16);
+  }
+  middle = t.stop();
+  std::cout << std::setw(20) << name
+            << std::setw(12) << back
+            << std::setw(12) << front
+            << std::setw(12) << middle << std::endl;
+}
+
 void benchmark_map(void);
+void benchmark_map_scaling(void);
+void benchmark_map_range(void);
+void benchmark_map_pool(void);
+void benchmark_map_erase_range(void);
+void benchmark_map_merge(void);
+void benchmark_map_algebra(void);
+void benchmark_btree_map(void);
+void benchmark_flat_map(void);
+void benchmark_frozen_map(void);
+void benchmark_compact_map(void);
+void benchmark_concurrent_map(void);
+void benchmark_persistent_map(void);
+void benchmark_map_batch(void);
+void benchmark_map_finger(void);
+void benchmark_map_aggregate(void);
 void benchmark_set(void);
 void benchmark_stack(void);
 void benchmark_vector(void);
+void benchmark_vector_erase(void);
 
 Timer::Timer(void) : __start(0) {}
 Timer::Timer(const Timer& t) : __start(t.__start) {}
@@ -121,6 +575,381 @@ void benchmark_map(void) {
   std::cout << std::endl;
 }
 
+void benchmark_map_range(void) {
+  std::cout << "\033[1;34m--- MAP RANGE BENCHMARK ⚡ ---\033[0m" << std::endl;
+  std::clock_t std;
+  std::clock_t ft;
+  std::vector<std::pair<int, bool> > std_sorted;
+  ft::vector<ft::pair<int, bool> > ft_sorted;
+  for (int i = 0 ; i < 1000000 ; i++) {
+    std_sorted.push_back(std::make_pair(i, true));
+    ft_sorted.push_back(ft::make_pair(i, true));
+  }
+  std = map_range_construct<std::map<int, bool> >(std_sorted);
+  std::cout << "std: " << std << std::endl;
+  ft = map_range_construct<ft::map<int, bool> >(ft_sorted);
+  std::cout << "ft: " << ft << std::endl;
+  if (static_cast<double>(ft) / static_cast<double>(std) < 1.0000) {
+  std::cout << "our map is " << static_cast<double>(std) / static_cast<double>(ft) << " times faster. ";
+  } else {
+    std::cout << "our map is " << static_cast<double>(ft) / static_cast<double>(std) << " times slower. ";
+  }
+  if (static_cast<double>(ft) / static_cast<double>(std) < 20.0000) {
+    std::cout << "\033[1;32m[PASS]\033[0m" << std::endl;
+  } else {
+    std::cout << "\033[1;31m[FAIL]\033[0m" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+void benchmark_map_erase_range(void) {
+  std::cout << "\033[1;34m--- MAP RANGE ERASE BENCHMARK ⚡ ---\033[0m" << std::endl;
+  std::clock_t std;
+  std::clock_t ft;
+  std::map<int, bool> std_map;
+  ft::map<int, bool> ft_map;
+  std = map_erase_front(1000000, std_map);
+  std::cout << "std: " << std << std::endl;
+  ft = map_erase_front(1000000, ft_map);
+  std::cout << "ft: " << ft << std::endl;
+  if (static_cast<double>(ft) / static_cast<double>(std) < 1.0000) {
+  std::cout << "our map is " << static_cast<double>(std) / static_cast<double>(ft) << " times faster. ";
+  } else {
+    std::cout << "our map is " << static_cast<double>(ft) / static_cast<double>(std) << " times slower. ";
+  }
+  if (static_cast<double>(ft) / static_cast<double>(std) < 20.0000) {
+    std::cout << "\033[1;32m[PASS]\033[0m" << std::endl;
+  } else {
+    std::cout << "\033[1;31m[FAIL]\033[0m" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+void benchmark_map_merge(void) {
+  std::cout << "\033[1;34m--- MAP MERGE BENCHMARK ⚡ ---\033[0m" << std::endl;
+  std::clock_t std;
+  std::clock_t ft;
+  std::map<int, bool> std_map, std_other;
+  ft::map<int, bool> ft_map, ft_other;
+  Timer t;
+  /* std has no merge before c++17, one insert per key */
+  map_merge_fill(1000000, 1000000, std_map, std_other);
+  t.start();
+  std_map.insert(std_other.begin(), std_other.end());
+  std = t.stop();
+  std::cout << "std: " << std << std::endl;
+  map_merge_fill(1000000, 1000000, ft_map, ft_other);
+  t.start();
+  ft_map.merge(ft_other);
+  ft = t.stop();
+  std::cout << "ft: " << ft << std::endl;
+  if (static_cast<double>(ft) / static_cast<double>(std) < 1.0000) {
+  std::cout << "our map is " << static_cast<double>(std) / static_cast<double>(ft) << " times faster. ";
+  } else {
+    std::cout << "our map is " << static_cast<double>(ft) / static_cast<double>(std) << " times slower. ";
+  }
+  if (static_cast<double>(ft) / static_cast<double>(std) < 20.0000) {
+    std::cout << "\033[1;32m[PASS]\033[0m" << std::endl;
+  } else {
+    std::cout << "\033[1;31m[FAIL]\033[0m" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+/* wall ms for 2M keys against 2M / ratio, the two key sets overlap */
+void benchmark_map_algebra(void) {
+  static const unsigned threads[] = {1, 2, 4, 8};
+  std::cout << "\033[1;34m--- MAP SET ALGEBRA (wall ms) ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(8) << "ratio"
+            << std::setw(14) << "op"
+            << std::setw(10) << "naive";
+  for (std::size_t k = 0 ; k < sizeof(threads) / sizeof(*threads) ; k++) {
+    std::cout << std::setw(9) << threads[k] << "t";
+  }
+  std::cout << std::endl << std::fixed << std::setprecision(1);
+  for (std::size_t ratio = 1 ; ratio <= 100 ; ratio *= 10) {
+    std::size_t n = 2000000;
+    ft::map<int, bool> a;
+    ft::map<int, bool> b;
+    for (std::size_t i = 0 ; i < n ; i++) {
+      a[scramble_key(i, n / 2)] = true;
+    }
+    for (std::size_t i = 0 ; i < n / ratio ; i++) {
+      b[scramble_key(i + n / 2, n / 2)] = true;
+    }
+    for (int op = 0 ; op < 2 ; op++) {
+      double start = wall_ms();
+      std::size_t sum = map_naive_algebra(a, b, op == 1).size();
+      std::cout << std::setw(8) << ratio
+                << std::setw(14) << (op == 0 ? "union" : "intersection")
+                << std::setw(10) << wall_ms() - start;
+      for (std::size_t k = 0 ; k < sizeof(threads) / sizeof(*threads) ; k++) {
+        start = wall_ms();
+        if (op == 0) {
+          sum += ft::map_union(a, b, threads[k]).size();
+        } else {
+          sum += ft::map_intersection(a, b, threads[k]).size();
+        }
+        std::cout << std::setw(10) << wall_ms() - start;
+      }
+      std::cout << "  (" << sum % 10 << ")" << std::endl;
+    }
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_btree_map(void) {
+  std::cout << "\033[1;34m--- BTREE MAP ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(12) << "container"
+            << std::setw(12) << "insert"
+            << std::setw(12) << "lookup"
+            << std::setw(12) << "scan" << std::endl;
+  map_layout<std::map<int, bool> >("std::map", 2000000);
+  map_layout<ft::map<int, bool> >("ft::map", 2000000);
+  map_layout<ft::btree_map<int, bool> >("btree_map", 2000000);
+  std::cout << std::endl;
+}
+
+/* built once from scrambled keys, then read only */
+void benchmark_flat_map(void) {
+  std::cout << "\033[1;34m--- FLAT MAP ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(12) << "container"
+            << std::setw(12) << "build"
+            << std::setw(12) << "lookup"
+            << std::setw(12) << "scan" << std::endl;
+  map_bulk_layout<std::map<int, bool>, std::pair<int, bool> >("std::map", 2000000);
+  map_bulk_layout<ft::map<int, bool>, ft::pair<int, bool> >("ft::map", 2000000);
+  map_bulk_layout<ft::btree_map<int, bool>, ft::pair<int, bool> >("btree_map", 2000000);
+  map_bulk_layout<ft::flat_map<int, bool>, ft::pair<int, bool> >("flat_map", 2000000);
+  std::cout << std::endl;
+}
+
+void benchmark_frozen_map(void) {
+  const std::size_t times = 2000000;
+  ft::map<int, bool> map;
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map[scramble_key(i, times)] = true;
+  }
+  ft::frozen_map<int, bool> frozen = map.freeze();
+  ft::flat_map<int, bool> flat(map.begin(), map.end());
+  std::cout << "\033[1;34m--- FROZEN MAP ⚡ ---\033[0m" << std::endl;
+#ifdef __AVX2__
+  std::cout << "(avx2 block compare)" << std::endl;
+#endif
+  std::cout << std::setw(12) << "container"
+            << std::setw(12) << "ms"
+            << std::setw(12) << "M/sec" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  map_lookup_rate("ft::map", map, times);
+  map_lookup_rate("flat_map", flat, times);
+  map_lookup_rate("frozen_map", frozen, times);
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_compact_map(void) {
+  std::cout << "\033[1;34m--- COMPACT MAP ⚡ ---\033[0m" << std::endl;
+  std::cout << "node bytes for <int, int>: ft::map "
+            << sizeof(ft::map<int, int>::tree_type::node_type)
+            << ", compact_map "
+            << sizeof(ft::compact_map<int, int>::tree_type::node_type) << std::endl;
+  std::cout << std::setw(12) << "container"
+            << std::setw(12) << "insert"
+            << std::setw(12) << "lookup"
+            << std::setw(12) << "scan" << std::endl;
+  map_layout<ft::map<int, int> >("ft::map", 2000000);
+  map_layout<ft::compact_map<int, int> >("compact_map", 2000000);
+  std::cout << std::endl;
+}
+
+void benchmark_concurrent_map(void) {
+  const std::size_t ops = 2000000;
+  const int keys = 1 << 18;
+  const int threads[] = {1, 2, 4, 8};
+  const int reads[] = {90, 50, 10};
+  std::cout << "\033[1;34m--- CONCURRENT MAP ⚡ ---\033[0m" << std::endl;
+  std::cout << "Mops/sec, " << ops << " operations over " << keys << " keys" << std::endl;
+  std::cout << std::setw(8) << "threads"
+            << std::setw(8) << "reads"
+            << std::setw(12) << "locked map"
+            << std::setw(12) << "concurrent" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  for (int r = 0 ; r < 3 ; r++) {
+    for (int t = 0 ; t < 4 ; t++) {
+      std::cout << std::setw(8) << threads[t]
+                << std::setw(7) << reads[r] << "%"
+                << std::setw(12) << map_workload_rate<locked_map>(threads[t], reads[r], ops, keys)
+                << std::setw(12) << map_workload_rate<ft::concurrent_map<int, int> >(threads[t], reads[r], ops, keys)
+                << std::endl;
+    }
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_persistent_map(void) {
+  const std::size_t times = 1000000;
+  const std::size_t updates = 200000;
+  const std::size_t period = 10000;
+  std::cout << "\033[1;34m--- PERSISTENT MAP ⚡ ---\033[0m" << std::endl;
+  std::cout << updates << " updates of " << times << " keys, a snapshot every " << period << std::endl;
+  std::cout << std::setw(16) << "container"
+            << std::setw(12) << "snapshot ms"
+            << std::setw(12) << "updates ms"
+            << std::setw(12) << "size" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  map_snapshot_updates<ft::map<int, int> >("ft::map", times, updates, period);
+  map_snapshot_updates<ft::persistent_map<int, int> >("persistent_map", times, updates, period);
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_map_batch(void) {
+  const std::size_t times = 4000000;
+  const std::size_t batch = 4096;
+  ft::map<int, int> map;
+  std::vector<int> keys(times);
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map.insert(ft::make_pair(scramble_key(i, times), static_cast<int>(i)));
+    keys[i] = scramble_key(i * 7 + 3, times);
+  }
+  std::cout << "\033[1;34m--- MAP BATCHED LOOKUP ⚡ ---\033[0m" << std::endl;
+  std::cout << times << " finds on " << times << " keys, batches of " << batch << std::endl;
+  std::cout << std::setw(12) << "queries"
+            << std::setw(12) << "find ms"
+            << std::setw(12) << "many ms"
+            << std::setw(12) << "speedup" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  map_batch_lookup("random", map, keys, batch);
+  for (std::size_t i = 0 ; i < times ; i += batch) {
+    std::sort(keys.begin() + i, keys.begin() + std::min(i + batch, times));
+  }
+  map_batch_lookup("sorted", map, keys, batch);
+  for (std::size_t i = 0 ; i < times ; i++) {
+    keys[i] = static_cast<int>(i);
+  }
+  map_batch_lookup("dense", map, keys, batch);
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_map_finger(void) {
+  const std::size_t times = 4000000;
+  const int gaps[] = {1, 16, 256, 4096};
+  ft::map<int, int> map;
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map.insert(ft::make_pair(scramble_key(i, times), static_cast<int>(i)));
+  }
+  std::cout << "\033[1;34m--- MAP FINGER SEARCH ⚡ ---\033[0m" << std::endl;
+  std::cout << times << " lower_bound on " << times << " keys one in 4 apart, ascending by gap" << std::endl;
+  std::cout << std::setw(12) << "gap"
+            << std::setw(12) << "root ms"
+            << std::setw(12) << "hint ms"
+            << std::setw(12) << "speedup" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  for (int g = 0 ; g < 4 ; g++) {
+    map_finger_walk(map, gaps[g], static_cast<int>(times * 4), times);
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_map_aggregate(void) {
+  typedef ft::map<int, long, ft::less<int>, std::allocator<ft::pair<const int, long> >,
+                  ft::node_pool_policy, ft::aggregate_node_update<ft::mapped_sum<long> > > sum_map;
+  const std::size_t times = 1000000;
+  const std::size_t queries = 2000;
+  const int widths[] = {100, 1000, 10000};
+  sum_map map;
+  for (std::size_t i = 0 ; i < times ; i++) {
+    map.insert(ft::make_pair(scramble_key(i, times), static_cast<long>(i % 1500)));
+  }
+  std::cout << "\033[1;34m--- MAP RANGE AGGREGATE ⚡ ---\033[0m" << std::endl;
+  std::cout << queries << " sums over key windows of " << times << " keys" << std::endl;
+  std::cout << std::setw(12) << "window"
+            << std::setw(12) << "walk ms"
+            << std::setw(12) << "aggregate"
+            << std::setw(12) << "speedup" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  for (int w = 0 ; w < 3 ; w++) {
+    long walk_sum = 0;
+    long tree_sum = 0;
+    double start = wall_ms();
+    for (std::size_t i = 0 ; i < queries ; i++) {
+      int lo = scramble_key(i * 7 + 3, times);
+      sum_map::const_iterator it = map.lower_bound(lo);
+      for (; it != map.end() && it->first < lo + widths[w] ; ++it) {
+        walk_sum += it->second;
+      }
+    }
+    double walk_ms = wall_ms() - start;
+    start = wall_ms();
+    for (std::size_t i = 0 ; i < queries ; i++) {
+      int lo = scramble_key(i * 7 + 3, times);
+      tree_sum += map.aggregate(lo, lo + widths[w]);
+    }
+    double tree_ms = wall_ms() - start;
+    std::cout << std::setw(12) << widths[w]
+              << std::setw(12) << walk_ms
+              << std::setw(12) << tree_ms
+              << std::setw(11) << walk_ms / tree_ms << "x"
+              << (walk_sum == tree_sum ? "" : "  (mismatch)") << std::endl;
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+/* rows run in one process: heap churn left by a per-node row can slow the next one */
+void benchmark_map_pool(void) {
+  typedef std::allocator<ft::pair<const int, bool> > alloc;
+  std::cout << "\033[1;34m--- MAP NODE STORAGE ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(12) << "storage"
+            << std::setw(12) << "insert"
+            << std::setw(12) << "traverse"
+            << std::setw(12) << "destroy" << std::endl;
+  map_node_storage<std::map<int, bool> >("std", 2000000);
+  map_node_storage<ft::map<int, bool, ft::less<int>, alloc, ft::node_allocator_policy> >("allocator", 2000000);
+  map_node_storage<ft::map<int, bool, ft::less<int>, alloc, ft::node_pool_policy> >("pool", 2000000);
+  std::cout << std::endl;
+}
+
+/* per-op cost should grow with log2(n): the last column stays roughly flat */
+void benchmark_map_scaling(void) {
+  std::cout << "\033[1;34m--- MAP SCALING ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(10) << "n"
+            << std::setw(14) << "insert ns/op"
+            << std::setw(14) << "erase ns/op"
+            << std::setw(18) << "(ins+era)/log2n" << std::endl;
+  for (std::size_t n = 1 << 10 ; n <= (1 << 20) ; n <<= 2) {
+    ft::map<int, bool> ft_map;
+    double ins = static_cast<double>(map_insert_scrambled(n, ft_map));
+    double era = static_cast<double>(map_erase_scrambled(n, ft_map));
+    ins = ins * 1e9 / CLOCKS_PER_SEC / static_cast<double>(n);
+    era = era * 1e9 / CLOCKS_PER_SEC / static_cast<double>(n);
+    std::cout << std::setw(10) << n
+              << std::setw(14) << std::fixed << std::setprecision(1) << ins
+              << std::setw(14) << era
+              << std::setw(18) << std::setprecision(2) << (ins + era) / std::log(static_cast<double>(n)) * std::log(2.0)
+              << std::endl;
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6) << std::endl;
+}
+
+void benchmark_set(void) {
+  std::cout << "\033[1;34m--- SET ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(14) << "container"
+            << std::setw(12) << "insert"
+            << std::setw(12) << "count"
+            << std::setw(12) << "erase" << std::endl;
+  set_layout<std::set<int> >("std::set", 1000000, 1);
+  set_layout<ft::set<int> >("ft::set", 1000000, 1);
+  set_layout<std::multiset<int> >("std::multiset", 1000000, 8);
+  set_layout<ft::multiset<int> >("ft::multiset", 1000000, 8);
+  std::cout << std::endl;
+}
+
 void benchmark_stack(void) {
   std::cout << "\033[1;34m--- STACK BENCHMARK ⚡ ---\033[0m" << std::endl;
   std::clock_t std;
@@ -167,6 +996,19 @@ void benchmark_vector(void) {
   std::cout << std::endl;
 }
 
+void benchmark_vector_erase(void) {
+  std::cout << "\033[1;34m--- VECTOR ERASE ⚡ ---\033[0m" << std::endl;
+  std::cout << std::setw(20) << "container"
+            << std::setw(12) << "back"
+            << std::setw(12) << "front"
+            << std::setw(12) << "middle" << std::endl;
+  vector_erase_layout<std::vector<int> >("std::vector<int>", 40000, 42);
+  vector_erase_layout<ft::vector<int> >("ft::vector<int>", 40000, 42);
+  vector_erase_layout<std::vector<std::string> >("std::vector<string>", 10000, std::string(24, 'x'));
+  vector_erase_layout<ft::vector<std::string> >("ft::vector<string>", 10000, std::string(24, 'x'));
+  std::cout << std::endl;
+}
+
 int main(void) {
   std::cout << "\033[1;94m" <<
     "# ****************************************************************************** #\n"
@@ -176,7 +1018,24 @@ int main(void) {
     "# ****************************************************************************** #\n"
             << "\033[0m" << std::endl;
   benchmark_map();
+  benchmark_map_scaling();
+  benchmark_map_range();
+  benchmark_map_pool();
+  benchmark_map_erase_range();
+  benchmark_map_merge();
+  benchmark_map_algebra();
+  benchmark_map_batch();
+  benchmark_map_finger();
+  benchmark_map_aggregate();
+  benchmark_btree_map();
+  benchmark_flat_map();
+  benchmark_frozen_map();
+  benchmark_compact_map();
+  benchmark_concurrent_map();
+  benchmark_persistent_map();
+  benchmark_set();
   benchmark_stack();
   benchmark_vector();
+  benchmark_vector_erase();
   return 0;
 }
@@ -0,0 +1,564 @@
+#include <pthread.h>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include "../includes/btree_map.hpp"
+#include "../includes/concurrent_map.hpp"
+#include "../includes/map.hpp"
+#include "../includes/multimap.hpp"
+#include "../includes/persistent_map.hpp"
+#include "../includes/set_algebra.hpp"
+#include "../includes/vector.hpp"
+
+/* checks that are not a plain ft vs std output diff: threads, exceptions */
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+int failures = 0;
+
+void check(bool ok, const char* what, int line) {
+  if (!ok) {
+    std::cout << "\033[1;31m[FAIL]\033[0m line " << line << ": " << what << std::endl;
+    ++failures;
+  }
+}
+
+/* a value whose copy throws once copies_left runs out, live counts the
+   objects alive so a leak or a double destroy shows up */
+int copies_left = -1;
+int live = 0;
+
+struct thrower {
+  int v;
+
+  thrower(int value = 0) : v(value) { ++live; }
+  thrower(const thrower& other) : v(other.v) {
+    if (copies_left == 0) {
+      throw 42;
+    }
+    if (copies_left > 0) {
+      --copies_left;
+    }
+    ++live;
+  }
+  ~thrower() { --live; }
+  thrower& operator=(const thrower& other) {
+    v = other.v;
+    return *this;
+  }
+};
+
+// runs f with the copy number n throwing, true if it did throw
+template <typename F>
+bool throws_on_copy(int n, F f) {
+  copies_left = n;
+  try {
+    f();
+  } catch (int) {
+    copies_left = -1;
+    return true;
+  }
+  copies_left = -1;
+  return false;
+}
+
+/* a throwing copy while the vector grows leaves it as it was */
+typedef ft::vector<thrower> thrower_vector;
+
+thrower_vector* tv;
+
+bool holds_0_to_7(const thrower_vector& v) {
+  bool ok = v.size() == 8;
+  for (std::size_t i = 0 ; ok && i < v.size() ; i++) {
+    ok = v[i].v == static_cast<int>(i);
+  }
+  return ok;
+}
+
+void tv_push_back(void) { tv->push_back(thrower(8)); }
+void tv_reserve(void) { tv->reserve(100); }
+void tv_insert_fill(void) { tv->insert(tv->begin() + 3, 4, thrower(8)); }
+void tv_insert_range(void) { tv->insert(tv->begin() + 5, tv->begin(), tv->end()); }
+
+void test_vector_strong(void) {
+  void (*grows[])(void) = {&tv_push_back, &tv_reserve, &tv_insert_fill, &tv_insert_range};
+
+  for (std::size_t g = 0 ; g < sizeof(grows) / sizeof(grows[0]) ; g++) {
+    for (int n = 0 ; n < 12 ; n++) {
+      thrower_vector v;
+      for (int i = 0 ; i < 8 ; i++) {
+        v.push_back(thrower(i));
+      }
+      std::size_t cap = v.capacity();
+      tv = &v;
+      if (throws_on_copy(n, grows[g])) {
+        CHECK(holds_0_to_7(v));
+        CHECK(v.capacity() == cap);
+      }
+      CHECK(live == static_cast<int>(v.size()));
+    }
+  }
+
+  // an insert in place throwing part way still leaves every slot alive
+  for (int n = 0 ; n < 8 ; n++) {
+    thrower_vector v;
+    v.reserve(32);
+    for (int i = 0 ; i < 8 ; i++) {
+      v.push_back(thrower(i));
+    }
+    tv = &v;
+    throws_on_copy(n, &tv_insert_fill);
+    CHECK(live == static_cast<int>(v.size()));
+  }
+  CHECK(live == 0);
+}
+
+#if __cplusplus >= 201103L
+/* the argument of a growing emplace_back may be one of the elements */
+void test_emplace_alias(void) {
+  ft::vector<std::string> v;
+  v.push_back(std::string(40, 'a'));
+  v.emplace_back(v[0]);
+  CHECK(v.size() == 2 && v[1] == std::string(40, 'a'));
+  v.push_back(std::string(40, 'b'));
+  v.push_back(std::string(40, 'c'));
+  CHECK(v.size() == v.capacity());
+  v.push_back(std::move(v[2]));
+  CHECK(v.size() == 5 && v[4] == std::string(40, 'b'));
+}
+#endif
+
+/* an erase that throws while copying shared nodes loses no other key */
+typedef ft::persistent_map<int, thrower> thrower_map;
+
+thrower_map* tm;
+
+void tm_erase_3(void) { tm->erase(3); }
+
+void test_persistent_erase(void) {
+  for (int n = 0 ; n < 24 ; n++) {
+    {
+      thrower_map m;
+      for (int i = 0 ; i < 8 ; i++) {
+        m.insert(ft::make_pair(i, thrower(i)));
+      }
+      thrower_map snap = m.snapshot();
+      tm = &m;
+      bool threw = throws_on_copy(n, &tm_erase_3);
+      std::size_t seen = 0;
+      for (thrower_map::iterator it = m.begin() ; it != m.end() ; ++it) {
+        CHECK(it->first == it->second.v);
+        ++seen;
+      }
+      CHECK(seen == m.size());
+      // 3 itself may be out already when a throw comes from above it
+      CHECK(m.size() == 7 + m.count(3));
+      CHECK(threw || m.count(3) == 0);
+      for (int i = 0 ; i < 8 ; i++) {
+        CHECK(i == 3 || m.count(i) == 1);
+        CHECK(snap.count(i) == 1);
+      }
+      CHECK(snap.size() == 8);
+    }
+    CHECK(live == 0);
+  }
+}
+
+/* an update invalidates the iterators of its own version only: a
+   snapshot can be walked while the map it came from is erased from */
+typedef ft::persistent_map<int, int> int_pmap;
+
+void test_persistent_snapshot_walk(void) {
+  int_pmap m;
+  for (int i = 0 ; i < 100 ; i++) {
+    m.insert(ft::make_pair(i, i));
+  }
+  int_pmap snap = m.snapshot();
+  int_pmap::const_iterator it = snap.find(50);
+  m.erase(30);
+  ++it;
+  CHECK(it != snap.end() && it->first == 51);
+
+  int seen = 0;
+  for (it = snap.begin() ; it != snap.end() ; ++it) {
+    CHECK(it->first == seen && it->second == seen);
+    m.erase(it->first);
+    m.erase(99 - it->first);
+    ++seen;
+  }
+  CHECK(seen == 100 && snap.size() == 100);
+  CHECK(m.empty() && m.begin() == m.end());
+}
+
+/* a map copy that throws part way frees what it cloned, the nodes it
+   was going to reuse included, and leaves the target empty. Each tree
+   also keeps a default value in its sentinel */
+typedef ft::map<int, thrower> thrower_tree;
+
+thrower_tree* tt;
+thrower_tree* tt_copy;
+
+void tt_assign(void) { *tt_copy = *tt; }
+void tt_construct(void) { thrower_tree c(*tt); }
+
+void test_map_copy_throw(void) {
+  thrower_tree m;
+  for (int i = 0 ; i < 100 ; i++) {
+    m.insert(ft::make_pair(i, thrower(i)));
+  }
+  tt = &m;
+  for (int n = 0 ; n < 100 ; n += 9) {
+    thrower_tree other;
+    for (int i = 0 ; i < 40 ; i++) {
+      other.insert(ft::make_pair(-i, thrower(-i)));
+    }
+    tt_copy = &other;
+    if (throws_on_copy(n, &tt_assign)) {
+      CHECK(other.empty() && other.begin() == other.end());
+    }
+    CHECK(live == static_cast<int>(m.size() + other.size() + 2));
+    throws_on_copy(n, &tt_construct);
+    CHECK(live == static_cast<int>(m.size() + other.size() + 2));
+    other = m;
+    CHECK(other.size() == m.size() && other.begin()->first == 0 && (--other.end())->first == 99);
+  }
+}
+
+/* a throwing copy inside a btree leaves every leaf whole: an insert is
+   undone, an erase is done or not, a copy of the tree is left empty */
+typedef ft::btree_map<int, thrower> thrower_btree;
+
+thrower_btree* bt;
+thrower_btree* bt_copy;
+int bt_key;
+
+void bt_insert(void) { bt->insert(ft::make_pair(bt_key, thrower(bt_key))); }
+void bt_erase(void) { bt->erase(bt_key); }
+void bt_assign(void) { *bt_copy = *bt; }
+void bt_construct(void) { thrower_btree c(*bt); }
+
+bool same_keys(const thrower_btree& m, const std::set<int>& s) {
+  thrower_btree::const_iterator it = m.begin();
+  std::size_t seen = 0;
+
+  for (std::set<int>::const_iterator k = s.begin() ; k != s.end() ; ++k, ++it, ++seen) {
+    if (it == m.end() || it->first != *k || it->second.v != *k) {
+      return false;
+    }
+  }
+  return it == m.end() && seen == m.size();
+}
+
+void test_btree_throw(void) {
+  for (int n = 0 ; n < 6 ; n++) {
+    thrower_btree m;
+    std::set<int> s;
+    for (int i = 0 ; i < 10 ; i += 2) {
+      m.insert(ft::make_pair(i, thrower(i)));
+      s.insert(i);
+    }
+    bt = &m;
+    bt_key = 1;
+    if (!throws_on_copy(n, &bt_insert)) {
+      s.insert(1);
+    }
+    CHECK(same_keys(m, s));
+    CHECK(live == static_cast<int>(m.size()));
+  }
+
+  // over many leaves, with splits, borrows and merges on the way
+  std::srand(11);
+  for (int n = 0 ; n < 4 ; n++) {
+    thrower_btree m;
+    std::set<int> s;
+    bt = &m;
+    for (int i = 0 ; i < 6000 ; i++) {
+      bt_key = std::rand() % 1500;
+      if (std::rand() % 3) {
+        if (!throws_on_copy(i % 7 ? -1 : n, &bt_insert)) {
+          s.insert(bt_key);
+        }
+      } else {
+        throws_on_copy(i % 5 ? -1 : n, &bt_erase);
+        if (m.count(bt_key) == 0) {
+          s.erase(bt_key);
+        }
+      }
+      if (i % 500 == 0 && !same_keys(m, s)) {
+        break;
+      }
+    }
+    CHECK(same_keys(m, s));
+    CHECK(live == static_cast<int>(m.size()));
+
+    thrower_btree other;
+    other.insert(ft::make_pair(-1, thrower(-1)));
+    bt_copy = &other;
+    for (int c = 0 ; c < 3 ; c++) {
+      int at = c * static_cast<int>(m.size()) / 2;
+      if (throws_on_copy(at, &bt_assign)) {
+        CHECK(other.empty() && other.begin() == other.end());
+      }
+      CHECK(live == static_cast<int>(m.size() + other.size()));
+      throws_on_copy(at, &bt_construct);
+      CHECK(live == static_cast<int>(m.size() + other.size()));
+    }
+    other = m;
+    CHECK(same_keys(other, s));
+  }
+  CHECK(live == 0);
+}
+
+/* split and merge leave two maps on one node arena, each is then used by
+   its own thread */
+typedef ft::map<int, int> int_map;
+
+struct churn {
+  int_map* map;
+  int lo;
+  int hi;
+};
+
+void* churn_run(void* arg) {
+  churn* c = static_cast<churn*>(arg);
+  for (int round = 0 ; round < 20 ; round++) {
+    for (int i = c->lo ; i < c->hi ; i += 2) {
+      c->map->erase(i);
+    }
+    for (int i = c->lo ; i < c->hi ; i += 2) {
+      c->map->insert(ft::make_pair(i, i));
+    }
+  }
+  return NULL;
+}
+
+void* destroy_run(void* arg) {
+  delete static_cast<int_map*>(arg);
+  return NULL;
+}
+
+void churn_pair(int_map& a, int a_lo, int a_hi, int_map& b, int b_lo, int b_hi) {
+  churn ca = {&a, a_lo, a_hi};
+  churn cb = {&b, b_lo, b_hi};
+  pthread_t ta;
+  pthread_t tb;
+  pthread_create(&ta, NULL, &churn_run, &ca);
+  pthread_create(&tb, NULL, &churn_run, &cb);
+  pthread_join(ta, NULL);
+  pthread_join(tb, NULL);
+}
+
+void test_shared_arena(void) {
+  const int n = 20000;
+  int_map* a = new int_map;
+  int_map* b = new int_map;
+  for (int i = 0 ; i < n ; i++) {
+    a->insert(ft::make_pair(i, i));
+  }
+  a->split_at(n / 2, *b);
+  churn_pair(*a, 0, n / 2, *b, n / 2, n);
+  CHECK(a->size() == static_cast<std::size_t>(n / 2));
+  CHECK(b->size() == static_cast<std::size_t>(n / 2));
+
+  int_map* c = new int_map;
+  for (int i = n ; i < 2 * n ; i++) {
+    c->insert(ft::make_pair(i, i));
+  }
+  b->merge(*c);
+  churn_pair(*b, n / 2, 2 * n, *c, 0, 0);
+  CHECK(b->size() == static_cast<std::size_t>(n + n / 2));
+
+  pthread_t ta;
+  pthread_t tb;
+  pthread_create(&ta, NULL, &destroy_run, a);
+  pthread_create(&tb, NULL, &destroy_run, b);
+  pthread_join(ta, NULL);
+  pthread_join(tb, NULL);
+  delete c;
+}
+
+/* threads insert, erase, find and scan one concurrent map at once. Every
+   scan under a guard sees strictly increasing keys, and at the end the map
+   holds exactly what the successful inserts minus erases left */
+typedef ft::concurrent_map<int, int> int_cmap;
+
+struct mixer {
+  int_cmap* map;
+  unsigned int seed;
+  long inserted;
+  long erased;
+  long bad;
+};
+
+void* mixer_run(void* arg) {
+  mixer* m = static_cast<mixer*>(arg);
+  unsigned int x = m->seed;
+
+  for (int i = 0 ; i < 20000 ; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    int k = static_cast<int>(x % 1024);
+    int op = static_cast<int>((x >> 12) % 10);
+    if (op < 4) {
+      m->inserted += m->map->insert(ft::make_pair(k, 2 * k)).second;
+    } else if (op < 7) {
+      m->erased += m->map->erase(k);
+    } else if (op < 9) {
+      int_cmap::guard g(*m->map);
+      int_cmap::iterator it = m->map->find(k);
+      m->bad += it != m->map->end() && (it->first != k || it->second != 2 * k);
+    } else {
+      int_cmap::guard g(*m->map);
+      int prev = -1;
+      int steps = 0;
+      for (int_cmap::iterator it = m->map->lower_bound(k) ; it != m->map->end() && steps < 64 ; ++it, ++steps) {
+        m->bad += it->first <= prev || it->first < k;
+        prev = it->first;
+      }
+    }
+  }
+  return NULL;
+}
+
+void test_concurrent_mixed(void) {
+  const int n = 8;
+  int_cmap map;
+  mixer work[n];
+  pthread_t threads[n];
+  long expected = 0;
+
+  for (int t = 0 ; t < n ; t++) {
+    mixer w = {&map, 2654435761u * (t + 1), 0, 0, 0};
+    work[t] = w;
+    pthread_create(&threads[t], NULL, &mixer_run, &work[t]);
+  }
+  for (int t = 0 ; t < n ; t++) {
+    pthread_join(threads[t], NULL);
+    CHECK(work[t].bad == 0);
+    expected += work[t].inserted - work[t].erased;
+  }
+
+  long seen = 0;
+  int prev = -1;
+  for (int_cmap::iterator it = map.begin() ; it != map.end() ; ++it, ++seen) {
+    CHECK(it->first > prev && it->second == 2 * it->first);
+    prev = it->first;
+  }
+  CHECK(seen == expected);
+  CHECK(static_cast<long>(map.size()) == expected);
+}
+
+/* a copy throwing in a worker of the parallel set algebra reaches the
+   caller instead of ending the process. The poisoned key is set before
+   the threads start and only read by them, it is never 0: the sentinel
+   of every tree holds a default value */
+int poison = -1;
+
+struct poisoned {
+  int v;
+
+  poisoned(int value = 0) : v(value) {}
+  poisoned(const poisoned& other) : v(other.v) {
+    if (v == poison) {
+      throw 42;
+    }
+  }
+};
+
+typedef ft::map<int, poisoned> poisoned_map;
+
+void test_algebra_throw(void) {
+  const int n = 40000;
+  poisoned_map a;
+  poisoned_map b;
+
+  for (int i = 0 ; i < n ; i++) {
+    (i % 3 ? a : b).insert(ft::make_pair(i, poisoned(i)));
+  }
+  for (int p = 1 ; p < n ; p += n / 16) {
+    poison = p;
+    bool threw = false;
+    try {
+      ft::map_union(a, b, 4);
+    } catch (int) {
+      threw = true;
+    }
+    poison = -1;
+    CHECK(threw);
+  }
+  CHECK(ft::map_union(a, b, 4).size() == static_cast<std::size_t>(n));
+}
+
+/* equal keys land where std::multimap puts them for any hint */
+typedef ft::multimap<int, int> ft_multi;
+typedef std::multimap<int, int> std_multi;
+
+bool same_order(const ft_multi& f, const std_multi& s) {
+  ft_multi::const_iterator fi = f.begin();
+  std_multi::const_iterator si = s.begin();
+
+  if (f.size() != s.size()) {
+    return false;
+  }
+  for (; si != s.end() ; ++fi, ++si) {
+    if (fi->first != si->first || fi->second != si->second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_multimap_hint(void) {
+  ft_multi f;
+  std_multi s;
+  int keys[] = {1, 5, 9};
+
+  for (int i = 0 ; i < 3 ; i++) {
+    f.insert(ft::make_pair(keys[i], 0));
+    s.insert(std::make_pair(keys[i], 0));
+  }
+  f.insert(f.begin(), ft::make_pair(5, 2));
+  s.insert(s.begin(), std::make_pair(5, 2));
+  CHECK(same_order(f, s));
+
+  std::srand(7);
+  for (int i = 0 ; i < 20000 ; i++) {
+    int k = std::rand() % 64;
+    std::size_t at = std::rand() % (s.size() + 1);
+    ft_multi::iterator fh = f.begin();
+    std_multi::iterator sh = s.begin();
+    while (at-- > 0) {
+      ++fh;
+      ++sh;
+    }
+    CHECK(f.insert(fh, ft::make_pair(k, i))->second == i);
+    s.insert(sh, std::make_pair(k, i));
+    if (i % 1000 == 0 && !same_order(f, s)) {
+      CHECK(same_order(f, s));
+      break;
+    }
+  }
+  CHECK(same_order(f, s));
+}
+
+int main(void) {
+  test_shared_arena();
+  test_concurrent_mixed();
+  test_vector_strong();
+  test_persistent_erase();
+  test_persistent_snapshot_walk();
+  test_map_copy_throw();
+  test_btree_throw();
+  test_algebra_throw();
+  test_multimap_hint();
+#if __cplusplus >= 201103L
+  test_emplace_alias();
+#endif
+  if (failures == 0) {
+    std::cout << "\033[1;32m[PASS]\033[0m" << std::endl;
+  }
+  return failures == 0 ? 0 : 1;
+}